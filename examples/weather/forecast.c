@@ -29,6 +29,8 @@ int main(int argc, char** argv) {
 
     dasi_t* dasi;
     dasi_key_t* key;
+    dasi_key_t* leaf;
+    dasi_archive_handle_t* handle;
 
     int step;
     int level;
@@ -137,6 +139,7 @@ int main(int argc, char** argv) {
     ASSERT_SUCCESS(stat, dasi_key_set(key, "version", version));
     ASSERT_SUCCESS(stat, dasi_key_set(key, "date", fc_date));
     ASSERT_SUCCESS(stat, dasi_key_set(key, "time", fc_time));
+    ASSERT_SUCCESS(stat, dasi_new_key(&leaf));
 
     for (number = 0; number < num_members; ++number) {
         /* generate parameter values */
@@ -154,26 +157,31 @@ int main(int argc, char** argv) {
             snprintf(sbuf, sizeof(sbuf), "%d", step);
             ASSERT_SUCCESS(stat, dasi_key_set(key, "step", sbuf));
 
+            /* Only level and param change below here */
+            ASSERT_SUCCESS(stat, dasi_prepare(dasi, key, &handle));
+
             /* LEVELS */
             for (level = 0; level < num_levels; ++level) {
                 snprintf(sbuf, sizeof(sbuf), "%d", level);
-                ASSERT_SUCCESS(stat, dasi_key_set(key, "level", sbuf));
+                ASSERT_SUCCESS(stat, dasi_key_set(leaf, "level", sbuf));
 
                 /* PARAMETERS */
                 for (par = 0; par < n_params; ++par) {
                     char data[20];
                     ASSERT_SUCCESS(
-                        stat, dasi_key_set(key, "param", param_names[par]));
+                        stat, dasi_key_set(leaf, "param", param_names[par]));
                     snprintf(data, sizeof(data), "%.10lg\n",
                              vals[par] - level * incr[par]);
 
                     /* ARCHIVE */
-                    stat = dasi_archive(dasi, key, (void*)data,
-                                        (long)strlen(data));
+                    stat = dasi_prepared_archive(handle, leaf, (void*)data,
+                                                 (long)strlen(data));
                     if (stat != DASI_SUCCESS) {
                         fprintf(stderr,
                                 "Could not write data! Level: %d Param: %s\n",
                                 level, param_names[par]);
+                        ASSERT_SUCCESS(stat, dasi_free_archive_handle(handle));
+                        ASSERT_SUCCESS(stat, dasi_free_key(leaf));
                         ASSERT_SUCCESS(stat, dasi_free_key(key));
                         ASSERT_SUCCESS(stat, dasi_close(dasi));
                         return 1;
@@ -181,6 +189,7 @@ int main(int argc, char** argv) {
 
                 } /* parameters */
             }     /* levels */
+            ASSERT_SUCCESS(stat, dasi_free_archive_handle(handle));
             /* increment values */
             for (par = 0; par < n_params; ++par) {
                 vals[par] += incr[par];
@@ -189,6 +198,7 @@ int main(int argc, char** argv) {
         printf("\n");
     } /* numbers */
 
+    ASSERT_SUCCESS(stat, dasi_free_key(leaf));
     ASSERT_SUCCESS(stat, dasi_free_key(key));
     ASSERT_SUCCESS(stat, dasi_close(dasi));
 
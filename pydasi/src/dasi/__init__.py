@@ -18,6 +18,7 @@ from .query import Query
 from .wipe import Wipe
 from .list import List
 from .retrieve import Retrieve
+from .serialisation import Encoder, Decoder, ListElement
 from .backend import DASIException
 from .utils.config import Config
 from .utils.version import __version__
@@ -30,6 +31,9 @@ __all__ = [
     "Wipe",
     "List",
     "Retrieve",
+    "Encoder",
+    "Decoder",
+    "ListElement",
     "DASIException",
     "Config",
 ]
@@ -24,7 +24,10 @@ from ._dasi_cffi import (
     new_query,
     new_wipe,
     new_list,
+    new_list_options,
     new_retrieve,
+    new_encoder,
+    new_decoder,
     check_type,
 )
 
@@ -40,6 +43,9 @@ __all__ = [
     "new_query",
     "new_wipe",
     "new_list",
+    "new_list_options",
     "new_retrieve",
+    "new_encoder",
+    "new_decoder",
     "check_type",
 ]
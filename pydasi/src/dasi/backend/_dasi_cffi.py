@@ -52,9 +52,14 @@ def read_lib_version(lib) -> str:
     return ffi_decode(tmp[0])
 
 
-def new_dasi(config: str) -> FFI.CData:
+def new_dasi(config: str, application_config: str = None) -> FFI.CData:
     cdasi = ffi.new("dasi_t **")
-    lib.dasi_open(cdasi, ffi_encode(config))
+    if application_config is None:
+        lib.dasi_open(cdasi, ffi_encode(config))
+    else:
+        lib.dasi_open_with_application_config(
+            cdasi, ffi_encode(config), ffi_encode(application_config)
+        )
     return ffi.gc(cdasi[0], lib.dasi_close)
 
 
@@ -88,11 +93,23 @@ def new_wipe(
     return ffi.gc(cwipe[0], lib.dasi_free_wipe)
 
 
-def new_list(cdasi: FFI.CData, cquery: FFI.CData) -> FFI.CData:
+def new_list_options() -> FFI.CData:
+    coptions = ffi.new("dasi_list_options_t **")
+    lib.dasi_new_list_options(coptions)
+    return ffi.gc(coptions[0], lib.dasi_free_list_options)
+
+
+def new_list(
+    cdasi: FFI.CData, cquery: FFI.CData, coptions: FFI.CData = None
+) -> FFI.CData:
     check_type(cdasi, "dasi_t *")
     check_type(cquery, "dasi_query_t *")
     clist = ffi.new("dasi_list_t **")
-    lib.dasi_list(cdasi, cquery, clist)
+    if coptions is None:
+        lib.dasi_list(cdasi, cquery, clist)
+    else:
+        check_type(coptions, "dasi_list_options_t *")
+        lib.dasi_list_with_options(cdasi, cquery, coptions, clist)
     return ffi.gc(clist[0], lib.dasi_free_list)
 
 
@@ -104,6 +121,18 @@ def new_retrieve(cdasi: FFI.CData, cquery: FFI.CData) -> FFI.CData:
     return ffi.gc(cret[0], lib.dasi_free_retrieve)
 
 
+def new_encoder() -> FFI.CData:
+    cencoder = ffi.new("dasi_encoder_t **")
+    lib.dasi_new_encoder(cencoder)
+    return ffi.gc(cencoder[0], lib.dasi_free_encoder)
+
+
+def new_decoder(data: bytes) -> FFI.CData:
+    cdecoder = ffi.new("dasi_decoder_t **")
+    lib.dasi_new_decoder(cdecoder, ffi.from_buffer(data), len(data))
+    return ffi.gc(cdecoder[0], lib.dasi_free_decoder)
+
+
 def check_type(cobj: FFI.CData, name: str):
     cname = ffi.typeof(cobj).cname
     if cname != name:
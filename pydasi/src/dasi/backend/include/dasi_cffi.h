@@ -4,6 +4,7 @@ typedef int wchar_t;
 typedef long double max_align_t;
 typedef int dasi_bool_t;
 typedef long dasi_time_t;
+typedef void (*dasi_free_fn_t)(void *data, void *user_data);
 struct Dasi;
 typedef struct Dasi dasi_t;
 struct Key;
@@ -16,8 +17,26 @@ struct dasi_purge_t;
 typedef struct dasi_purge_t dasi_purge_t;
 struct dasi_list_t;
 typedef struct dasi_list_t dasi_list_t;
+struct dasi_axes_t;
+typedef struct dasi_axes_t dasi_axes_t;
+struct dasi_list_options_t;
+typedef struct dasi_list_options_t dasi_list_options_t;
+typedef enum dasi_list_fields_t {
+  DASI_LIST_KEYS = 0,
+  DASI_LIST_KEYS_TIMESTAMP = 1,
+  DASI_LIST_FULL = 2,
+  DASI_LIST_LOCATIONS = 3
+} dasi_list_fields_t;
 struct dasi_retrieve_t;
 typedef struct dasi_retrieve_t dasi_retrieve_t;
+struct dasi_archive_handle_t;
+typedef struct dasi_archive_handle_t dasi_archive_handle_t;
+struct dasi_archive_stream_t;
+typedef struct dasi_archive_stream_t dasi_archive_stream_t;
+struct dasi_encoder_t;
+typedef struct dasi_encoder_t dasi_encoder_t;
+struct dasi_decoder_t;
+typedef struct dasi_decoder_t dasi_decoder_t;
 typedef enum dasi_error_values_t {
   DASI_SUCCESS = 0,
   DASI_ITERATION_COMPLETE = 1,
@@ -32,20 +51,36 @@ int dasi_version(const char **version);
 int dasi_vcs_version(const char **sha1);
 int dasi_initialise_api(void);
 int dasi_open(dasi_t **dasi, const char *config);
+int dasi_open_with_application_config(dasi_t **dasi, const char *config, const char *application_config);
 int dasi_close(const dasi_t *dasi);
 int dasi_archive(dasi_t *dasi, const dasi_key_t *key, const void *data, long length);
+int dasi_archive_owned(dasi_t *dasi, const dasi_key_t *key, void *data, long length, dasi_free_fn_t free_fn, void *user_data);
+int dasi_archive_stream_open(dasi_t *dasi, const dasi_key_t *key, long length_hint, dasi_archive_stream_t **stream);
+int dasi_archive_stream_write(dasi_archive_stream_t *stream, const void *data, long length);
+int dasi_archive_stream_commit(dasi_archive_stream_t *stream);
+int dasi_free_archive_stream(const dasi_archive_stream_t *stream);
+int dasi_prepare(dasi_t *dasi, const dasi_key_t *prefix, dasi_archive_handle_t **handle);
+int dasi_prepared_archive(dasi_archive_handle_t *handle, const dasi_key_t *key, const void *data, long length);
+int dasi_free_archive_handle(const dasi_archive_handle_t *handle);
+int dasi_archive_batch(dasi_t *dasi, const dasi_key_t * const keys[], const void * const data[], const long lengths[], long count);
 int dasi_flush(dasi_t *dasi);
+int dasi_stats_json(const dasi_t *dasi, const char **json);
 int dasi_list(dasi_t *dasi, const dasi_query_t *query, dasi_list_t **list);
+int dasi_list_with_options(dasi_t *dasi, const dasi_query_t *query, const dasi_list_options_t *options, dasi_list_t **list);
 int dasi_free_list(const dasi_list_t *list);
 int dasi_list_count(const dasi_list_t *list, long *count);
 int dasi_list_next(dasi_list_t *list);
 int dasi_list_attrs(const dasi_list_t *list, dasi_key_t **key, dasi_time_t *timestamp, const char **uri, long *offset, long *length);
+int dasi_list_checksum(const dasi_list_t *list, dasi_bool_t *has_checksum, unsigned long *checksum);
+int dasi_list_encode(const dasi_list_t *list, const void **data, long *length);
+int dasi_list_cursor(const dasi_list_t *list, const char **cursor);
 int dasi_retrieve(dasi_t *dasi, const dasi_query_t *query, dasi_retrieve_t **retrieve);
 int dasi_free_retrieve(const dasi_retrieve_t *retrieve);
 int dasi_retrieve_read(dasi_retrieve_t *retrieve, void *data, long *length);
 int dasi_retrieve_count(const dasi_retrieve_t *retrieve, long *count);
 int dasi_retrieve_next(dasi_retrieve_t *retrieve);
 int dasi_retrieve_attrs(const dasi_retrieve_t *retrieve, dasi_key_t **key, dasi_time_t *timestamp, long *offset, long *length);
+int dasi_retrieve_checksum(const dasi_retrieve_t *retrieve, dasi_bool_t *has_checksum, unsigned long *checksum);
 int dasi_wipe(dasi_t *dasi, const dasi_query_t *query, const dasi_bool_t *doit, const dasi_bool_t *all, dasi_wipe_t **wipe);
 int dasi_free_wipe(const dasi_wipe_t *wipe);
 int dasi_wipe_next(dasi_wipe_t *wipe);
@@ -65,6 +100,21 @@ int dasi_key_has(dasi_key_t *key, const char *keyword, dasi_bool_t *has);
 int dasi_key_count(dasi_key_t *key, long *count);
 int dasi_key_erase(dasi_key_t *key, const char *keyword);
 int dasi_key_clear(dasi_key_t *key);
+int dasi_key_hash(const dasi_key_t *key, unsigned long long *hash);
+int dasi_key_encode(const dasi_key_t *key, const void **data, long *length);
+int dasi_new_key_from_encoded(dasi_key_t **key, const void *data, long length);
+int dasi_axes(dasi_t *dasi, const dasi_query_t *query, int level, dasi_axes_t **axes);
+int dasi_free_axes(const dasi_axes_t *axes);
+int dasi_axes_keyword_count(const dasi_axes_t *axes, long *count);
+int dasi_axes_get_keyword(const dasi_axes_t *axes, long n, const char **keyword);
+int dasi_axes_value_count(const dasi_axes_t *axes, const char *keyword, long *count);
+int dasi_axes_get_value(const dasi_axes_t *axes, const char *keyword, long n, const char **value);
+int dasi_new_list_options(dasi_list_options_t **options);
+int dasi_free_list_options(const dasi_list_options_t *options);
+int dasi_list_options_set_fields(dasi_list_options_t *options, dasi_list_fields_t fields);
+int dasi_list_options_set_since(dasi_list_options_t *options, dasi_time_t since);
+int dasi_list_options_set_limit(dasi_list_options_t *options, long limit);
+int dasi_list_options_set_cursor(dasi_list_options_t *options, const char *cursor);
 int dasi_new_query(dasi_query_t **query);
 int dasi_new_query_from_string(dasi_query_t **query, const char *str);
 int dasi_free_query(const dasi_query_t *query);
@@ -76,3 +126,18 @@ int dasi_query_get(dasi_query_t *query, const char *keyword, int num, const char
 int dasi_query_has(dasi_query_t *query, const char *keyword, dasi_bool_t *has);
 int dasi_query_erase(dasi_query_t *query, const char *keyword);
 int dasi_query_clear(dasi_query_t *query);
+int dasi_query_encode(const dasi_query_t *query, const void **data, long *length);
+int dasi_new_query_from_encoded(dasi_query_t **query, const void *data, long length);
+int dasi_new_encoder(dasi_encoder_t **encoder);
+int dasi_free_encoder(const dasi_encoder_t *encoder);
+int dasi_encoder_add_key(dasi_encoder_t *encoder, const dasi_key_t *key);
+int dasi_encoder_add_query(dasi_encoder_t *encoder, const dasi_query_t *query);
+int dasi_encoder_add_list_element(dasi_encoder_t *encoder, const dasi_list_t *list);
+int dasi_encoder_buffer(const dasi_encoder_t *encoder, const void **data, long *length);
+int dasi_encoder_clear(dasi_encoder_t *encoder);
+int dasi_new_decoder(dasi_decoder_t **decoder, const void *data, long length);
+int dasi_free_decoder(const dasi_decoder_t *decoder);
+int dasi_decoder_done(const dasi_decoder_t *decoder, dasi_bool_t *done);
+int dasi_decoder_next_key(dasi_decoder_t *decoder, dasi_key_t **key);
+int dasi_decoder_next_query(dasi_decoder_t *decoder, dasi_query_t **query);
+int dasi_decoder_next_list_element(dasi_decoder_t *decoder, dasi_key_t **key, dasi_time_t *timestamp, const char **uri, long *offset, long *length, dasi_bool_t *has_checksum, unsigned long *checksum);
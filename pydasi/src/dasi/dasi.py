@@ -13,9 +13,12 @@
 # limitations under the License.
 
 
-from dasi.backend import ffi, lib, new_dasi
+import json
+
+from dasi.backend import ffi, lib, new_dasi, ffi_decode
 
 from dasi.key import Key
+from dasi.query import Query
 from dasi.wipe import Wipe
 from dasi.list import List
 from dasi.retrieve import Retrieve
@@ -34,11 +37,13 @@ class Dasi:
         dasi = Dasi("config.yaml")
     """
 
-    def __init__(self, config: str):
+    def __init__(self, config: str, application_config: str = None):
         """
         Creates a DASI session.
 
         :param str config: the configuration file.
+        :param str application_config: the application configuration (yaml),
+            e.g. to set an automatic flush policy.
         """
         from dasi.utils import log
 
@@ -48,7 +53,7 @@ class Dasi:
 
         self._log.debug("Initialize Dasi...")
 
-        self._cdata = new_dasi(config)
+        self._cdata = new_dasi(config, application_config)
 
     def archive(self, key, data):
         """
@@ -76,17 +81,67 @@ class Dasi:
 
         return Wipe(self._cdata, query, doit, all)
 
-    def list(self, query) -> List:
+    def list(
+        self,
+        query,
+        fields: str = "full",
+        since: int = None,
+        limit: int = None,
+        cursor: str = None,
+    ) -> List:
         """List data present and retrievable from the archive
 
         :param query: A description of the span of metadata to list within
+        :param fields: The details to list: "keys", "timestamp" (keys and
+            timestamps), "locations" (also the locations as stored, without
+            reading the data) or "full". Leaving out the locations is much
+            cheaper.
+        :param since: Only list the objects archived at or after this time
+            (seconds since the epoch, as in the listed timestamps).
+        :param limit: List at most this many objects, as a page. The next page
+            is listed from the cursor of this one.
+        :param cursor: Continue a paged list, from the cursor of the last page.
         :return: An iterable details of the objects describing data.
         :rtype: List
         """
 
         self._log.debug("Listing...")
 
-        return List(self._cdata, query)
+        return List(self._cdata, query, fields, since, limit, cursor)
+
+    def axes(self, query, level: int = 3) -> dict:
+        """The distinct values of each keyword of the data in the archive
+
+        They are built from the index metadata, without visiting each object,
+        so cover the whole of each index that matches the query.
+
+        :param query: A description of the span of metadata to summarise
+        :param level: 1 for only the database keywords, 2 to add the index
+            keywords, or 3 for all the keywords
+        :return: The sorted values of each keyword
+        :rtype: dict
+        """
+
+        caxes = ffi.new("dasi_axes_t **")
+        lib.dasi_axes(self._cdata, Query(query).cdata, level, caxes)
+        caxes = ffi.gc(caxes[0], lib.dasi_free_axes)
+
+        nkeywords = ffi.new("long *", 0)
+        nvalues = ffi.new("long *", 0)
+        keyword = ffi.new("const char **")
+        value = ffi.new("const char **")
+
+        axes = {}
+        lib.dasi_axes_keyword_count(caxes, nkeywords)
+        for i in range(nkeywords[0]):
+            lib.dasi_axes_get_keyword(caxes, i, keyword)
+            lib.dasi_axes_value_count(caxes, keyword[0], nvalues)
+            values = []
+            for j in range(nvalues[0]):
+                lib.dasi_axes_get_value(caxes, keyword[0], j, value)
+                values.append(ffi_decode(value[0]))
+            axes[ffi_decode(keyword[0])] = values
+        return axes
 
     def retrieve(self, query) -> Retrieve:
         """Retrieve data objects from the archive
@@ -108,3 +163,14 @@ class Dasi:
         self._log.debug("Flushing...")
 
         lib.dasi_flush(self._cdata)
+
+    @property
+    def stats(self) -> dict:
+        """
+        Operation statistics of this session: call counts, bytes, total times
+        and latency histograms for each type of operation.
+        """
+
+        value = ffi.new("const char **")
+        lib.dasi_stats_json(self._cdata, value)
+        return json.loads(ffi_decode(value[0]))
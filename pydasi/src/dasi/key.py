@@ -75,6 +75,14 @@ class Key:
     def __eq__(self, other) -> bool:
         return self._compare(other) == 0
 
+    def __hash__(self) -> int:
+        """Hash of the contents, consistent with ==. A key must not be
+        modified while it is in a set or used as a dict key, as its hash would
+        no longer match where it is stored."""
+        value = ffi.new("unsigned long long *", 0)
+        lib.dasi_key_hash(self._cdata, value)
+        return value[0]
+
     def _compare(self, other) -> int:
         if isinstance(other, Key):
             value = ffi.new("int *", 0)
@@ -93,3 +101,16 @@ class Key:
 
     def clear(self):
         lib.dasi_key_clear(self._cdata)
+
+    def encode(self) -> bytes:
+        """Compact binary form of the key, see Key.decode()"""
+        data = ffi.new("const void **")
+        length = ffi.new("long *", 0)
+        lib.dasi_key_encode(self._cdata, data, length)
+        return ffi.buffer(data[0], length[0])[:]
+
+    @classmethod
+    def decode(cls, data: bytes) -> "Key":
+        ckey = ffi.new("dasi_key_t **")
+        lib.dasi_new_key_from_encoded(ckey, ffi.from_buffer(data), len(data))
+        return cls(ffi.gc(ckey[0], lib.dasi_free_key))
@@ -12,14 +12,25 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-from dasi.backend import FFI, ffi, lib, ffi_decode, new_list
+from dasi.backend import FFI, ffi, lib, ffi_decode, ffi_encode, new_list, new_list_options
 
 from dasi.key import Key
 from dasi.query import Query
 
 
 class List:
-    def __init__(self, dasi: FFI.CData, query):
+    FIELDS = ("keys", "timestamp", "full", "locations")
+    """The details that may be listed: only the keys, the keys and timestamps, or everything"""
+
+    def __init__(
+        self,
+        dasi: FFI.CData,
+        query,
+        fields: str = "full",
+        since: int = None,
+        limit: int = None,
+        cursor: str = None,
+    ):
         from dasi.utils import log
 
         self._log = log.getLogger(__name__)
@@ -31,7 +42,19 @@ class List:
         self.__time = ffi.new("dasi_time_t *", 0)
         self.__offset = ffi.new("long *", 0)
         self.__length = ffi.new("long *", 0)
-        self._cdata = new_list(dasi, Query(query).cdata)
+        self.__has_checksum = ffi.new("dasi_bool_t *", 0)
+        self.__checksum = ffi.new("unsigned long *", 0)
+        if fields not in self.FIELDS:
+            raise ValueError("fields must be one of {}".format(", ".join(self.FIELDS)))
+        options = new_list_options()
+        lib.dasi_list_options_set_fields(options, self.FIELDS.index(fields))
+        if since is not None:
+            lib.dasi_list_options_set_since(options, since)
+        if limit is not None:
+            lib.dasi_list_options_set_limit(options, limit)
+        if cursor is not None:
+            lib.dasi_list_options_set_cursor(options, ffi_encode(cursor))
+        self._cdata = new_list(dasi, Query(query).cdata, options)
 
     def __str__(self) -> str:
         return "{}, uri: {}, time: {}, offset: {}, length: {}".format(
@@ -48,8 +71,11 @@ class List:
         return self
 
     def __len__(self) -> int:
-        self._log.debug("not implemented in Dasi C lib!")
-        return 0
+        """Number of elements, counted without iterating over them. A paged list
+        counts the elements of its page: those after its cursor, up to its limit"""
+        count = ffi.new("long *", 0)
+        lib.dasi_list_count(self._cdata, count)
+        return count[0]
 
     def __read(self):
         ckey = ffi.new("dasi_key_t **", ffi.NULL)
@@ -63,6 +89,7 @@ class List:
         )
         ckey: FFI.CData = ffi.gc(ckey[0], lib.dasi_free_key)
         self.__key = Key(ckey)
+        lib.dasi_list_checksum(self._cdata, self.__has_checksum, self.__checksum)
 
     @property
     def key(self) -> Key:
@@ -84,3 +111,24 @@ class List:
     @property
     def length(self) -> int:
         return self.__length[0]
+
+    @property
+    def cursor(self):
+        """The cursor from which to continue a paged list, after the current
+        element (or the last, once iterated). None if there are no more."""
+        ccursor = ffi.new("const char **", ffi.NULL)
+        lib.dasi_list_cursor(self._cdata, ccursor)
+        cursor = ffi_decode(ccursor[0])
+        return cursor if cursor else None
+
+    def encode(self) -> bytes:
+        """Compact binary form of the current element"""
+        data = ffi.new("const void **")
+        length = ffi.new("long *", 0)
+        lib.dasi_list_encode(self._cdata, data, length)
+        return ffi.buffer(data[0], length[0])[:]
+
+    @property
+    def checksum(self):
+        """CRC-32C of the data, or None if it was archived without one"""
+        return self.__checksum[0] if self.__has_checksum[0] else None
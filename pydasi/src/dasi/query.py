@@ -98,3 +98,16 @@ class Query:
 
     def clear(self):
         lib.dasi_query_clear(self._cdata)
+
+    def encode(self) -> bytes:
+        """Compact binary form of the query, see Query.decode()"""
+        data = ffi.new("const void **")
+        length = ffi.new("long *", 0)
+        lib.dasi_query_encode(self._cdata, data, length)
+        return ffi.buffer(data[0], length[0])[:]
+
+    @classmethod
+    def decode(cls, data: bytes) -> "Query":
+        cquery = ffi.new("dasi_query_t **")
+        lib.dasi_new_query_from_encoded(cquery, ffi.from_buffer(data), len(data))
+        return cls(ffi.gc(cquery[0], lib.dasi_free_query))
@@ -31,6 +31,8 @@ class Retrieve:
         self.__time = ffi.new("dasi_time_t *", 0)
         self.__offset = ffi.new("long *", 0)
         self.__length = ffi.new("long *", 0)
+        self.__has_checksum = ffi.new("dasi_bool_t *", 0)
+        self.__checksum = ffi.new("unsigned long *", 0)
         self._cdata = new_retrieve(dasi, Query(query).cdata)
 
     def __str__(self) -> str:
@@ -59,6 +61,7 @@ class Retrieve:
         )
         ckey: FFI.CData = ffi.gc(ckey[0], lib.dasi_free_key)
         self.__key = Key(ckey)
+        lib.dasi_retrieve_checksum(self._cdata, self.__has_checksum, self.__checksum)
 
         self.__data = bytearray(self.length)
         lib.dasi_retrieve_read(
@@ -84,3 +87,8 @@ class Retrieve:
     @property
     def length(self) -> int:
         return self.__length[0]
+
+    @property
+    def checksum(self):
+        """CRC-32C of the data, or None if it was archived without one"""
+        return self.__checksum[0] if self.__has_checksum[0] else None
@@ -0,0 +1,108 @@
+# Copyright 2023 European Centre for Medium-Range Weather Forecasts (ECMWF)
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from collections import namedtuple
+
+from dasi.backend import ffi, lib, ffi_decode, new_encoder, new_decoder
+from dasi.key import Key
+from dasi.query import Query
+from dasi.list import List
+
+ListElement = namedtuple(
+    "ListElement", ["key", "timestamp", "uri", "offset", "length", "checksum"]
+)
+"""A list element decoded from a stream"""
+
+
+class Encoder:
+    """
+    Encodes keys, queries and list elements into one compact binary stream.
+    Each keyword is written in full only the first time it appears, so a
+    stream of similar keys is much smaller than their text forms (or than
+    encoding them one at a time).
+    """
+
+    def __init__(self):
+        lib.load()
+        self._cdata = new_encoder()
+
+    def add(self, value):
+        """Add a Key, a Query, or the current element of a List"""
+        if isinstance(value, Key):
+            lib.dasi_encoder_add_key(self._cdata, value.cdata)
+        elif isinstance(value, Query):
+            lib.dasi_encoder_add_query(self._cdata, value.cdata)
+        elif isinstance(value, List):
+            lib.dasi_encoder_add_list_element(self._cdata, value._cdata)
+        else:
+            raise TypeError("Cannot encode {}".format(type(value).__name__))
+
+    def encode(self) -> bytes:
+        """The stream encoded so far"""
+        data = ffi.new("const void **")
+        length = ffi.new("long *", 0)
+        lib.dasi_encoder_buffer(self._cdata, data, length)
+        return ffi.buffer(data[0], length[0])[:]
+
+    def clear(self):
+        """Start a new stream"""
+        lib.dasi_encoder_clear(self._cdata)
+
+
+class Decoder:
+    """
+    Decodes a stream written by an Encoder (or by encode()). The records must
+    be decoded as the types they were encoded as, in the same order.
+    """
+
+    def __init__(self, data: bytes):
+        lib.load()
+        self._cdata = new_decoder(data)
+
+    @property
+    def done(self) -> bool:
+        """Have all the records been decoded?"""
+        done = ffi.new("dasi_bool_t *", 0)
+        lib.dasi_decoder_done(self._cdata, done)
+        return done[0] != 0
+
+    def next_key(self) -> Key:
+        ckey = ffi.new("dasi_key_t **")
+        lib.dasi_decoder_next_key(self._cdata, ckey)
+        return Key(ffi.gc(ckey[0], lib.dasi_free_key))
+
+    def next_query(self) -> Query:
+        cquery = ffi.new("dasi_query_t **")
+        lib.dasi_decoder_next_query(self._cdata, cquery)
+        return Query(ffi.gc(cquery[0], lib.dasi_free_query))
+
+    def next_list_element(self) -> ListElement:
+        ckey = ffi.new("dasi_key_t **")
+        timestamp = ffi.new("dasi_time_t *", 0)
+        uri = ffi.new("const char **", ffi.NULL)
+        offset = ffi.new("long *", 0)
+        length = ffi.new("long *", 0)
+        has_checksum = ffi.new("dasi_bool_t *", 0)
+        checksum = ffi.new("unsigned long *", 0)
+        lib.dasi_decoder_next_list_element(
+            self._cdata, ckey, timestamp, uri, offset, length, has_checksum, checksum
+        )
+        return ListElement(
+            Key(ffi.gc(ckey[0], lib.dasi_free_key)),
+            timestamp[0],
+            ffi_decode(uri[0]),
+            offset[0],
+            length[0],
+            checksum[0] if has_checksum[0] else None,
+        )
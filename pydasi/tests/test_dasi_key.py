@@ -14,7 +14,7 @@
 
 import pytest
 
-from dasi import Key
+from dasi import Decoder, Encoder, Key, Query
 from dasi.backend import DASIException, check_type
 
 
@@ -182,6 +182,60 @@ def test_key_compare():
     assert key == Key({"key1": "value1", "key2": "value2"})
 
 
+def test_key_hash():
+    key = Key({"key1": "value1", "key2": "value2"})
+    other = Key({"key2": "value2", "key1": "value1"})
+
+    assert hash(key) == hash(other)
+    assert len({key: 1, other: 2}) == 1
+
+    different = Key({"key1": "value1", "key2": "value3"})
+    assert hash(key) != hash(different)
+    assert len({key: 1, different: 2}) == 2
+
+
+def test_key_encode():
+    key = Key({"key1": "value1", "key2": "value2"})
+
+    data = key.encode()
+    assert isinstance(data, bytes)
+    assert Key.decode(data) == key
+
+    with pytest.raises(DASIException):
+        Key.decode(data[:-1])
+
+
+def test_key_stream():
+    keys = [
+        Key({"key1": "value1", "key2": "value{}".format(i), "key3": "value3"})
+        for i in range(10)
+    ]
+    query = Query({"key1": ["value1"], "key2": ["value1", "value2"]})
+
+    encoder = Encoder()
+    for key in keys:
+        encoder.add(key)
+    encoder.add(query)
+    data = encoder.encode()
+
+    assert len(data) < sum(len(key.encode()) for key in keys)
+
+    decoder = Decoder(data)
+    for key in keys:
+        assert not decoder.done
+        assert decoder.next_key() == key
+    decoded = decoder.next_query()
+    assert decoded.count_value("key2") == 2
+    assert decoded.get_value("key2", 1) == "value2"
+    assert decoder.done
+
+    with pytest.raises(DASIException):
+        decoder.next_key()
+
+    encoder.clear()
+    assert Decoder(encoder.encode()).done
+
+
 if __name__ == "__main__":
     test_key_typename()
     test_key_clear()
@@ -190,3 +244,6 @@ if __name__ == "__main__":
     test_key_invalid()
     test_key_dictionary()
     test_key_modify()
+    test_key_hash()
+    test_key_encode()
+    test_key_stream()
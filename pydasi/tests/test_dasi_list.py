@@ -130,6 +130,8 @@ def test_simple_list(dasi_cfg: str):
         "key3b": ["value1"],
     }
 
+    assert len(dasi.list(query)) == 3
+
     keys = []
     for item in dasi.list(query):
         keys.append(item.key)
@@ -139,6 +141,101 @@ def test_simple_list(dasi_cfg: str):
     assert keys[2] == Key(__list_2__)
 
 
+def test_list_fields(dasi_cfg: str):
+    """
+    Test listing only some of the details
+    """
+
+    dasi = Dasi(dasi_cfg)
+    dasi.archive(__list_0__, __simple_data_0__)
+    dasi.flush()
+
+    query = {key: [value] for key, value in __list_0__.items()}
+
+    for item in dasi.list(query, fields="keys"):
+        assert item.key == Key(__list_0__)
+        assert item.timestamp == 0
+        assert item.uri == ""
+
+    for item in dasi.list(query, fields="timestamp"):
+        assert item.timestamp != 0
+        assert item.length == 0
+
+    for item in dasi.list(query):
+        assert item.length == len(__simple_data_0__)
+
+    with pytest.raises(ValueError):
+        dasi.list(query, fields="location")
+
+
+def test_list_since(dasi_cfg: str):
+    """
+    Test listing only the objects archived after a time
+    """
+
+    dasi = Dasi(dasi_cfg)
+    dasi.archive(__list_0__, __simple_data_0__)
+    dasi.flush()
+
+    query = {key: [value] for key, value in __list_0__.items()}
+
+    latest = max(item.timestamp for item in dasi.list(query, fields="timestamp"))
+
+    assert len(dasi.list(query, since=latest)) == 1
+    assert [item.key for item in dasi.list(query, since=latest)] == [Key(__list_0__)]
+
+    assert len(dasi.list(query, since=latest + 1)) == 0
+    assert list(dasi.list(query, since=latest + 1)) == []
+
+
+def test_list_pages(dasi_cfg: str):
+    """
+    Test listing in pages, continued from a cursor
+    """
+
+    dasi = Dasi(dasi_cfg)
+    for item, data in ((__list_0__, __simple_data_0__), (__list_1__, __simple_data_1__)):
+        dasi.archive(item, data)
+    dasi.flush()
+
+    query = {"key2": ["123"], "key3": ["value1"]}
+    total = len(dasi.list(query))
+    assert total >= 2
+
+    keys = []
+    cursor = None
+    pages = 0
+    while True:
+        page = dasi.list(query, fields="keys", limit=1, cursor=cursor)
+        assert len(page) == min(1, total - len(keys))
+        keys.extend(str(item.key) for item in page)
+        cursor = page.cursor
+        pages += 1
+        if cursor is None:
+            break
+
+    assert pages == total
+    assert sorted(keys) == sorted(str(item.key) for item in dasi.list(query))
+
+
+def test_axes(dasi_cfg: str):
+    """
+    Test the distinct values of each keyword
+    """
+
+    dasi = Dasi(dasi_cfg)
+    for item, data in ((__list_0__, __simple_data_0__), (__list_1__, __simple_data_1__)):
+        dasi.archive(item, data)
+    dasi.flush()
+
+    axes = dasi.axes({"key2": ["123"], "key3": ["value1"]})
+    assert axes["key1"][:2] == ["value0", "value1"]
+    assert axes["key3b"] == ["value1"]
+
+    axes = dasi.axes({"key2": ["123"], "key3": ["value1"]}, level=1)
+    assert "value0" in axes["key1"]
+
+
 if __name__ == "__main__":
     retcode = pytest.main()
     print("Return Code: ", retcode)
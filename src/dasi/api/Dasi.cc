@@ -11,15 +11,29 @@
 #include "Dasi.h"
 
 #include "dasi/lib/LibDasi.h"
+#include "dasi/impl/ArchiveData.h"
+#include "dasi/impl/ArchiveHandleImpl.h"
+#include "dasi/impl/ArchiveStreamImpl.h"
+#include "dasi/impl/AsyncArchiver.h"
+#include "dasi/impl/AutoFlush.h"
+#include "dasi/impl/Deduplicator.h"
+#include "dasi/impl/Fnv1a.h"
+#include "dasi/impl/Metrics.h"
 #include "dasi/impl/WipeGeneratorImpl.h"
 #include "dasi/impl/PurgeGeneratorImpl.h"
+#include "dasi/impl/CatalogueCache.h"
 #include "dasi/impl/ListGeneratorImpl.h"
+#include "dasi/impl/PagedListGeneratorImpl.h"
+#include "dasi/impl/ParallelListGeneratorImpl.h"
+#include "dasi/impl/ObjectEncoding.h"
 #include "dasi/impl/PolicyStatusGeneratorImpl.h"
 #include "dasi/impl/RetrieveResultImpl.h"
+#include "dasi/impl/WriteCombiner.h"
 
 #include "fdb5/api/FDB.h"
 #include "fdb5/api/helpers/FDBToolRequest.h"
 #include "fdb5/config/Config.h"
+#include "fdb5/database/IndexAxis.h"
 #include "fdb5/rules/Schema.h"
 
 #include "eckit/config/YAMLConfiguration.h"
@@ -30,7 +44,13 @@
 
 #include "metkit/mars/MarsRequest.h"
 
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <unordered_set>
 
 namespace dasi {
 
@@ -121,6 +141,47 @@ fdb5::Config construct_config(const char* dasi_config, const char* application_c
     return retval;
 }
 
+// Conversion of DASI keys into FDB keys, reusing the work done for the previous key where the keywords are
+// unchanged. Consecutive objects in a batch typically differ only in their last-level values. Resolving the
+// database of each key against the schema, which costs more, is shared by all keys of a database (DatabaseKeys).
+
+class IncrementalKeyConverter {
+
+public: // methods
+
+    const fdb5::Key& convert(const Key& key) {
+
+        if (previous_ && sameKeywords(*previous_, key)) {
+            auto it = previous_->begin();
+            for (const auto& kv : key) {
+                if (kv.second != it->second) { fdbKey_.set(kv.first, kv.second); }
+                ++it;
+            }
+        } else {
+            fdbKey_ = fdb5::Key{};
+            for (const auto& kv : key) { fdbKey_.set(kv.first, kv.second); }
+        }
+
+        previous_ = &key;
+        return fdbKey_;
+    }
+
+private: // methods
+
+    static bool sameKeywords(const Key& lhs, const Key& rhs) {
+        if (lhs.size() != rhs.size()) return false;
+        for (auto l = lhs.begin(), r = rhs.begin(); r != rhs.end(); ++l, ++r) {
+            if (l.keyword() != r.keyword()) return false;
+        }
+        return true;
+    }
+
+private: // members
+
+    const Key* previous_ = nullptr;
+    fdb5::Key fdbKey_;
+};
+
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -129,46 +190,331 @@ class DasiImpl {
 
 public: // methods
     DasiImpl(const char* dasi_config, const char* application_config):
-        mainHelper_(), fdb_(construct_config(dasi_config, application_config)) { }
+        mainHelper_(),
+        appConfig_(parse_application_config(application_config)),
+        fdb_(construct_config(dasi_config, application_config)),
+        encoder_(std::make_shared<ObjectEncoder>(fdb_.config())),
+        verifyChecksums_(appConfig_.getSubConfiguration("retrieve").getBool("verify_checksum", true)),
+        listThreads_(appConfig_.getSubConfiguration("list").getUnsigned("threads", 1)),
+        listOrdered_(appConfig_.getSubConfiguration("list").getBool("ordered", true)),
+        metrics_(std::make_shared<Metrics>()) {
+
+        const auto archiveConfig = appConfig_.getSubConfiguration("archive");
+        if (archiveConfig.getBool("async", false)) {
+            asyncArchiver_ = std::make_unique<AsyncArchiver>(
+                    fdb_.config(), archiveConfig.getUnsigned("queue_bytes", defaultAsyncQueueBytes),
+                    archiveConfig.getUnsigned("writers", 1));
+        }
+
+        if (archiveConfig.getBool("dedup", false)) {
+            dedup_ = std::make_unique<Deduplicator>(
+                    fdb_.config().schema(), archiveConfig.getUnsigned("dedup_max_objects", defaultDedupMaxObjects));
+        }
+
+        if (archiveConfig.has("combine")) {
+            const auto combineConfig = archiveConfig.getSubConfiguration("combine");
+            auto index = [this](const fdb5::Key& key, const fdb5::FieldLocation& location) {
+                fdb_.reindex(key, location);
+            };
+            combiner_ = std::make_unique<WriteCombiner>(
+                    fdb_.config(), combineConfig.getUnsigned("object_bytes", defaultCombineObjectBytes),
+                    combineConfig.getUnsigned("buffer_bytes", defaultCombineBufferBytes), std::move(index));
+        }
+
+        if (appConfig_.has("cache")) {
+            cache_ = std::make_unique<CatalogueCache>(appConfig_.getSubConfiguration("cache"));
+            if (!cache_->enabled()) { cache_.reset(); }
+        }
+
+        // Last, as the timer may flush as soon as it is running
+        if (appConfig_.has("flush")) {
+            autoFlush_ = std::make_unique<AutoFlush>(appConfig_.getSubConfiguration("flush"),
+                                                     [this](AutoFlush::Trigger trigger) { flush(trigger); });
+        }
+    }
+
+    ~DasiImpl() {
+        autoFlush_.reset();
+
+        // Objects still held for write combining, or waiting to be indexed as duplicates, have been
+        // accepted by archive(), so must not be lost
+        try {
+            if ((combiner_ && !combiner_->empty()) || (dedup_ && dedup_->pending())) { flush(); }
+        } catch (const std::exception& e) {
+            eckit::Log::error() << "Failed to write archived objects: " << e.what() << std::endl;
+        }
+    }
 
     void archive(const Key& key, const void* data, size_t length) {
+        auto timer = metrics_->time(Metrics::Archive, length);
         fdb5::Key fdb_key;
         for (const auto& kv : key) { fdb_key.set(kv.first, kv.second); }
-        fdb_.archive(fdb_key, data, length);
+        auto lock = lockArchive();
+        archiveFDB(fdb_key, data, length);
+    }
+
+    void archive(const Key& key, ArchiveData&& data) {
+        auto timer = metrics_->time(Metrics::Archive, data.length());
+        archiveOwned(key, std::move(data));
+    }
+
+    void archive(const Key& key, eckit::DataHandle& handle) {
+
+        // The data is written to the store as it is read, in fixed-size chunks, so the object is never held in full
+
+        auto stream = archiveStream(key);
+
+        handle.openForRead();
+        eckit::AutoClose closer(handle);
+
+        const size_t estimate = handle.estimate();
+        eckit::Buffer buffer(std::min(streamChunkBytes, std::max(estimate, initialStreamBytes)));
+
+        for (;;) {
+            const long nread = handle.read(buffer.data(), buffer.size());
+            if (nread < 0) { throw eckit::ReadError("Failed to read the data to archive from " + handle.title(), Here()); }
+            if (nread == 0) break;
+            stream.write(buffer.data(), nread);
+        }
+
+        stream.commit();
+    }
+
+    void archiveBatch(const Key* const keys[], const void* const data[], const size_t lengths[], size_t count) {
+        auto timer = metrics_->time(Metrics::Archive);
+        IncrementalKeyConverter converter;
+        auto lock = lockArchive();
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT(keys[i]);
+            archiveFDB(converter.convert(*keys[i]), data[i], lengths[i]);
+            timer.addBytes(lengths[i]);
+        }
+    }
+
+    ArchiveHandle prepare(const Key& prefix) {
+        auto sink = [this](const fdb5::Key& key, const void* data, size_t length) {
+            auto timer = metrics_->time(Metrics::Archive, length);
+            auto lock = lockArchive();
+            archiveFDB(key, data, length);
+        };
+        return ArchiveHandle(std::make_unique<ArchiveHandleImpl>(prefix, fdb_.config().schema(), std::move(sink)));
+    }
+
+    ArchiveStream archiveStream(const Key& key) {
+        auto index = [this](const fdb5::Key& fdb_key, const fdb5::FieldLocation& location, size_t length) {
+            auto timer = metrics_->time(Metrics::Archive, length);
+            auto lock = lockArchive();
+            streamed(fdb_key);
+            // Earlier objects with the same key, still being written in the background, must not replace this one
+            if (asyncArchiver_) { asyncArchiver_->flush(); }
+            fdb_.reindex(fdb_key, location);
+            archived(length);
+        };
+        auto sink = [this](const fdb5::Key& fdb_key, ArchiveData&& data, size_t length) {
+            auto timer = metrics_->time(Metrics::Archive, length);
+            auto lock = lockArchive();
+            streamed(fdb_key);
+            if (asyncArchiver_) {
+                asyncArchiver_->archive(fdb_key, std::move(data));
+            } else {
+                fdb_.archive(fdb_key, data.data(), data.length());
+            }
+            archived(length);
+        };
+        return ArchiveStream(std::make_unique<ArchiveStreamImpl>(key, fdb_.config(), *encoder_, std::move(index),
+                                                                 std::move(sink)));
     }
 
     WipeGenerator wipe(const Query& query, const bool doit, const bool porcelain, const bool all) {
+        auto timer = metrics_->time(Metrics::Wipe);
+        auto lock = lockFDB();
+        invalidateCache();
         auto&& iter = fdb_.wipe(fdb5::FDBToolRequest(queryToMarsRequest(query)), doit, porcelain, all);
         return WipeGenerator(std::make_unique<WipeGeneratorImpl>(std::move(iter)));
     }
 
     PurgeGenerator purge(const Query& query, const bool doit, const bool porcelain) {
+        auto timer = metrics_->time(Metrics::Purge);
+        auto lock = lockFDB();
+        invalidateCache();
         auto&& iter = fdb_.purge(fdb5::FDBToolRequest(queryToMarsRequest(query)), doit, porcelain);
         return PurgeGenerator(std::make_unique<PurgeGeneratorImpl>(std::move(iter)));
     }
 
-    ListGenerator list(const Query& query) {
+    ListGenerator list(const Query& query, const ListOptions& options) {
+        auto timer = metrics_->time(Metrics::List);
+        auto lock = lockFDB();
+        const auto request = queryToMarsRequest(query);
+
+        // Only the full listing reads the envelopes, for the decoded lengths and checksums, and only
+        // of the objects in spaces with compression or checksums
+        std::shared_ptr<const ObjectEncoder> decode;
+        if (options.fields == ListFields::Full && encoder_->enabled()) { decode = encoder_; }
+
+        // Pages are listed in the order of the keys, so that a cursor can find its place
+        if (options.limit > 0 || !options.cursor.empty()) {
+            return ListGenerator(std::make_unique<PagedListGeneratorImpl>(fdb_.config(), request, options, decode));
+        }
+
+        std::string lookup;
+        if (cache_) {
+            lookup = cacheLookup("list", request);
+            if (auto elements = cache_->get(lookup)) {
+                return ListGenerator(std::make_unique<CachedListGeneratorImpl>(std::move(elements), options, decode));
+            }
+        }
+
+        if (listThreads_ > 1) {
+            auto databases = matchingDatabases(request);
+            if (databases.size() > 1) {
+                return ListGenerator(std::make_unique<ParallelListGeneratorImpl>(
+                        fdb_.config(), request, std::move(databases), listThreads_, listOrdered_, options, decode));
+            }
+        }
+
         bool deduplicate = true;
-        auto&& iter = fdb_.list(fdb5::FDBToolRequest(queryToMarsRequest(query)), deduplicate);
+        auto&& iter = fdb_.list(fdb5::FDBToolRequest(request), deduplicate);
+
+        // To be cached, the results must be held rather than streamed. They are only held while they
+        // fit in the cache, after which the rest of the listing is streamed after them.
+        if (cache_) {
+            const size_t maxElements = cache_->maxElements(lookup);
+            CatalogueCache::Elements elements;
+            fdb5::ListElement elem;
+            bool complete = false;
+            while (!complete && elements.size() <= maxElements) {
+                complete = !iter.next(elem);
+                if (!complete) { elements.push_back(elem); }
+            }
+            if (complete) {
+                auto cached = std::make_shared<const CatalogueCache::Elements>(std::move(elements));
+                cache_->put(lookup, cached);
+                return ListGenerator(std::make_unique<CachedListGeneratorImpl>(std::move(cached), options, decode));
+            }
+            return ListGenerator(
+                    std::make_unique<ListGeneratorImpl>(std::move(elements), std::move(iter), options, decode));
+        }
 
-        return ListGenerator(std::make_unique<ListGeneratorImpl>(std::move(iter)));
+        return ListGenerator(std::make_unique<ListGeneratorImpl>(std::move(iter), options, decode));
+    }
+
+    size_t count(const Query& query, const ListOptions& options) {
+        auto timer = metrics_->time(Metrics::List);
+        const auto request = queryToMarsRequest(query);
+
+        // A page is counted as it would be listed: after the key of its cursor, up to its limit
+        std::vector<fdb5::Key> after;
+        if (!options.cursor.empty()) { after = PagedListGeneratorImpl::cursorKey(options.cursor, request); }
+
+        // Overwritten fields are still present in older indexes, and the same database may be found
+        // under several roots, so each must be counted once. Rather than have the FDB remember every
+        // key, remember the hashes of the keys seen in each database, as matchingDatabases() does for
+        // the databases. Neither the DASI elements nor the URIs are built.
+        bool deduplicate = false;
+        auto lock = lockFDB();
+        auto&& iter = fdb_.list(fdb5::FDBToolRequest(request), deduplicate);
+        lock.unlock();
+
+        size_t count = 0;
+        std::map<fdb5::Key, std::unordered_set<uint64_t>> seen;
+        const fdb5::Key* database = nullptr;
+        std::unordered_set<uint64_t>* hashes = nullptr;
+        fdb5::ListElement elem;
+        while ((options.limit == 0 || count < options.limit) && iter.next(elem)) {
+            if (elem.timestamp() < options.since) continue;
+            const auto& parts = elem.key();
+            ASSERT(!parts.empty());
+            if (!after.empty() && !(after < parts)) continue;
+            if (!database || parts[0] != *database) {
+                auto it = seen.try_emplace(parts[0]).first;
+                database = &it->first;
+                hashes = &it->second;
+            }
+            uint64_t hash = fnv1aOffsetBasis;
+            for (const auto& part : parts) {
+                for (const auto& kv : part) {
+                    hash = fnv1a(hash, kv.first);
+                    hash = fnv1a(hash, kv.second);
+                }
+            }
+            if (hashes->insert(hash).second) ++count;
+        }
+        return count;
+    }
+
+    Axes axes(const Query& query, int level) {
+        auto timer = metrics_->time(Metrics::List);
+        if (level < 1 || level > 3) {
+            throw eckit::UserError("Axes level must be 1, 2 or 3, not " + std::to_string(level), Here());
+        }
+
+        auto lock = lockFDB();
+        const auto indexAxis = fdb_.axes(fdb5::FDBToolRequest(queryToMarsRequest(query)), level);
+
+        Axes axes;
+        for (const auto& kv : indexAxis.map()) {
+            auto& values = axes[kv.first];
+            values.assign(kv.second.begin(), kv.second.end());
+            std::sort(values.begin(), values.end());
+        }
+        return axes;
     }
 
     /// @todo - deduplicate FDB results inside the inspect() function instead
 
     RetrieveResult retrieve(const Query& query) {
-        auto&& iter = fdb_.inspect(queryToMarsRequest(query));
-        return RetrieveResult{std::make_unique<RetrieveResultImpl>(std::move(iter))};
+        auto timer = metrics_->time(Metrics::Retrieve);
+        auto lock = lockFDB();
+        const auto request = queryToMarsRequest(query);
+
+        std::unique_ptr<RetrieveResultImpl> result;
+        if (cache_) {
+            const auto lookup = cacheLookup("retrieve", request);
+            if (auto elements = cache_->get(lookup)) {
+                result = std::make_unique<RetrieveResultImpl>(*elements, encoder_, verifyChecksums_, metrics_);
+            } else {
+                // A retrieve holds all its elements anyway, but only copies them if they fit in the cache
+                CatalogueCache::Elements values;
+                fdb5::ListElement elem;
+                auto&& iter = fdb_.inspect(request);
+                while (iter.next(elem)) { values.push_back(elem); }
+                if (values.size() <= cache_->maxElements(lookup)) {
+                    cache_->put(lookup, std::make_shared<const CatalogueCache::Elements>(values));
+                }
+                result = std::make_unique<RetrieveResultImpl>(std::move(values), encoder_, verifyChecksums_, metrics_);
+            }
+        } else {
+            auto&& iter = fdb_.inspect(request);
+            result = std::make_unique<RetrieveResultImpl>(std::move(iter), encoder_, verifyChecksums_, metrics_);
+        }
+        timer.addBytes(result->storedLength());
+        return RetrieveResult{std::move(result)};
     }
 
-    void flush() {
+    void flush(AutoFlush::Trigger trigger = AutoFlush::Trigger::Explicit) {
+        auto timer = metrics_->time(Metrics::Flush);
+        auto lock = lockArchive();
+        if (combiner_ && !combiner_->empty()) { drainCombiner(); }
+        if (asyncArchiver_) {
+            asyncArchiver_->flush();
+        }
+        // Streamed and combined objects are indexed through this FDB, even when archiving in the background
         fdb_.flush();
+        // Duplicates can only be indexed once the originals are visible
+        if (dedup_ && dedup_->pending()) {
+            dedup_->resolve(fdb_);
+            fdb_.flush();
+        }
+        if (autoFlush_) { autoFlush_->flushed(trigger); }
     }
 
     PolicyGenerator setPolicy(const Query& query, const PolicyDict& policyDict) {
         /// @todo Put this properly through the entire FDB infrastructure. This implementation is a bit of a hack...
         /* Currently not wired into the FDB. */
 
+        // Access controls change what can be listed and retrieved
+        invalidateCache();
+
         if (policyDict.has("access")) {
 
             const auto& access = policyDict.getSubConfiguration("access");
@@ -193,6 +539,7 @@ public: // methods
                 foundAny = true;
             }
 
+            auto lock = lockFDB();
             auto&& iter = fdb_.control(fdb5::FDBToolRequest(queryToMarsRequest(query)),
                                        action,
                                        identifiers);
@@ -210,31 +557,250 @@ public: // methods
         std::vector<std::string> policySpecifiers;
         eckit::Tokenizer(".")(name, policySpecifiers);
 
+        auto lock = lockFDB();
         auto&& iter = fdb_.status(fdb5::FDBToolRequest(queryToMarsRequest(query)));
         return PolicyGenerator(std::make_unique<PolicyStatusGeneratorImpl>(std::move(iter), std::move(policySpecifiers)));
     }
 
     void dumpSchema(std::ostream& out) const { fdb_.config().schema().dump(out); }
 
+    Stats stats() const {
+        Stats stats = metrics_->snapshot();
+        if (autoFlush_) {
+            const auto counters = autoFlush_->counters();
+            stats.flushTriggers.explicitFlushes = counters.explicitFlushes;
+            stats.flushTriggers.maxBytes = counters.bytes;
+            stats.flushTriggers.maxObjects = counters.objects;
+            stats.flushTriggers.maxInterval = counters.interval;
+        }
+        if (cache_) {
+            const auto counters = cache_->counters();
+            stats.cache.hits = counters.hits;
+            stats.cache.misses = counters.misses;
+            stats.cache.stale = counters.stale;
+            stats.cache.evictions = counters.evictions;
+        }
+        return stats;
+    }
+
 private: // methods
 
+    /// The FDB is not thread safe, and timed flushes use it from the timer's thread, so every call
+    /// into it is serialised. The iterators it returns read the catalogues independently, so can be
+    /// used without the lock.
+    std::unique_lock<std::recursive_mutex> lockFDB() {
+        return std::unique_lock<std::recursive_mutex>(archiveMutex_);
+    }
+
+    /// Archive operations may race with timed flushes, so are serialised. The lock is recursive, as
+    /// archiving can itself trigger a flush.
+    ///
+    /// Everything that takes the lock (archive and flush) changes what is stored, so any cached
+    /// lookups are dropped.
+    std::unique_lock<std::recursive_mutex> lockArchive() {
+        std::unique_lock<std::recursive_mutex> lock(archiveMutex_);
+        if (autoFlush_) { autoFlush_->rethrowError(); }
+        invalidateCache();
+        return lock;
+    }
+
+    void invalidateCache() {
+        if (cache_) { cache_->clear(); }
+    }
+
+    /// Identifies a lookup in the catalogue cache
+    static std::string cacheLookup(const char* operation, const metkit::mars::MarsRequest& request) {
+        std::ostringstream ss;
+        ss << operation << ":" << request;
+        return ss.str();
+    }
+
+    /// Archive an object whose memory is handed over to the backend
+    void archiveOwned(const Key& key, ArchiveData&& data) {
+        fdb5::Key fdb_key;
+        for (const auto& kv : key) { fdb_key.set(kv.first, kv.second); }
+        auto lock = lockArchive();
+        const size_t length = data.length();
+        if (!isDuplicate(fdb_key, data.data(), length)) {
+            if (encoder_->enabled()) {
+                size_t encodedLength;
+                if (auto encoded = encoder_->encode(fdb_key, data.data(), length, encodedLength)) {
+                    data = ArchiveData(std::move(encoded), encodedLength);
+                }
+            }
+            if (!combine(fdb_key, data.data(), data.length())) {
+                if (asyncArchiver_) {
+                    asyncArchiver_->archive(fdb_key, std::move(data));
+                } else {
+                    fdb_.archive(fdb_key, data.data(), data.length());
+                }
+            }
+        }
+        archived(length);
+    }
+
+    void archiveFDB(const fdb5::Key& key, const void* data, size_t length) {
+        if (!isDuplicate(key, data, length)) { writeFDB(key, data, length); }
+        archived(length);
+    }
+
+    /// Apply the automatic flush policy, once an object has been accepted
+    void archived(size_t length) {
+        if (autoFlush_) {
+            const auto trigger = autoFlush_->archived(length);
+            if (trigger != AutoFlush::Trigger::None) { flush(trigger); }
+        }
+    }
+
+    /// Stage a small object to be written together with others of its database. Returns false if the object is
+    /// to be written on its own.
+    bool combine(const fdb5::Key& key, const void* data, size_t length) {
+        if (!combiner_) return false;
+        if (!combiner_->accepts(length)) {
+            // The latest object with a key must be the one indexed
+            if (combiner_->staged(key)) { drainCombiner(); }
+            return false;
+        }
+        if (combiner_->full(length)) { drainCombiner(); }
+        combiner_->stage(key, data, length);
+        return true;
+    }
+
+    /// Objects written before the staged ones, in the background, are flushed first, such that the
+    /// latest object with a key is the one indexed
+    void drainCombiner() {
+        if (asyncArchiver_) { asyncArchiver_->flush(); }
+        combiner_->drain();
+    }
+
+    /// A streamed object is archived without its content being seen, so is neither a duplicate nor an original
+    void streamed(const fdb5::Key& key) {
+        if (combiner_ && combiner_->staged(key)) { drainCombiner(); }
+        if (!dedup_) return;
+        // Overwriting an original changes what its duplicates would refer to, so index them first
+        if (dedup_->aliased(key)) { flush(); }
+        dedup_->forget(key);
+    }
+
+    /// Is the object a duplicate, that will be indexed rather than written?
+    bool isDuplicate(const fdb5::Key& key, const void* data, size_t length) {
+        if (!dedup_) return false;
+        // Overwriting an original changes what its duplicates would refer to, so index them first
+        if (dedup_->aliased(key)) { flush(); }
+        return dedup_->archive(key, data, length);
+    }
+
+    void writeFDB(const fdb5::Key& key, const void* data, size_t length) {
+        if (encoder_->enabled()) {
+            size_t encodedLength;
+            if (auto encoded = encoder_->encode(key, data, length, encodedLength)) {
+                if (combine(key, encoded->data(), encodedLength)) return;
+                if (asyncArchiver_) {
+                    asyncArchiver_->archive(key, ArchiveData(std::move(encoded), encodedLength));
+                } else {
+                    fdb_.archive(key, encoded->data(), encodedLength);
+                }
+                return;
+            }
+        }
+        if (combine(key, data, length)) return;
+        if (asyncArchiver_) {
+            asyncArchiver_->archive(key, data, length);
+        } else {
+            fdb_.archive(key, data, length);
+        }
+    }
+
+    /// The keys of the databases matching a request, once each even if present under several roots.
+    /// Must be called holding lockFDB().
+    std::vector<fdb5::Key> matchingDatabases(const metkit::mars::MarsRequest& request) {
+        std::vector<fdb5::Key> databases;
+        std::set<fdb5::Key> seen;
+        auto&& iter = fdb_.status(fdb5::FDBToolRequest(request));
+        fdb5::StatusElement elem;
+        while (iter.next(elem)) {
+            if (seen.insert(elem.key).second) { databases.push_back(elem.key); }
+        }
+        return databases;
+    }
+
+    /// Ranges in the query values are expanded straight into the request. A keyword whose value
+    /// is `all` is left out, so is unconstrained.
+    /// @throws eckit::UserError if a keyword's ranges expand to more than maxExpandedValues
     metkit::mars::MarsRequest queryToMarsRequest(const Query& query) {
         metkit::mars::MarsRequest rq("retrieve");
         for (const auto& kv : query) {
-            rq.values(kv.first, kv.second);
+            QueryValues values(kv.second);
+            if (values.all()) continue;
+            if (!values.hasRanges()) {
+                rq.values(kv.first, kv.second);
+                continue;
+            }
+            const size_t size = values.size();
+            if (size > maxExpandedValues) {
+                std::ostringstream ss;
+                ss << "Query values for '" << kv.first << "' expand to " << size << " values, more than the limit of "
+                   << maxExpandedValues << ". Use 'all', or split the query.";
+                throw eckit::UserError(ss.str(), Here());
+            }
+            std::vector<std::string> expanded;
+            expanded.reserve(size);
+            for (const auto& value : values) { expanded.push_back(value); }
+            rq.values(kv.first, expanded);
         }
         return rq;
     }
 
 private: // members
 
+    static constexpr size_t defaultAsyncQueueBytes = 256 * 1024 * 1024;
+    static constexpr size_t defaultDedupMaxObjects = 100000;
+    static constexpr size_t maxExpandedValues = 100000;
+    static constexpr size_t defaultCombineObjectBytes = 64 * 1024;
+    static constexpr size_t defaultCombineBufferBytes = 16 * 1024 * 1024;
+    static constexpr size_t streamChunkBytes = 64 * 1024 * 1024;
+    static constexpr size_t initialStreamBytes = 64 * 1024;
+
     // DASI may well be the first eckit-like entry point to the application.
     // If it is, then make sure that everything goes nicely.
     EckitMainHelper mainHelper_;
 
+    eckit::LocalConfiguration appConfig_;
+
     // The real deal, this is where most of the underlying work is done!
     fdb5::FDB fdb_;
 
+    // Compression and checksums are configured in the DASI configuration, as they describe how the
+    // data is stored. Envelopes are stripped on read from the spaces configured to have them, and
+    // any checksums checked unless retrieve.verify_checksum is false. Shared with the generators.
+    std::shared_ptr<const ObjectEncoder> encoder_;
+    bool verifyChecksums_;
+
+    // Databases listed at a time, and whether the output of a parallel list keeps the serial order
+    size_t listThreads_;
+    bool listOrdered_;
+
+    // Shared with the data handles of retrieve results, which may outlive this object
+    std::shared_ptr<Metrics> metrics_;
+
+    // Only present if archive.async is enabled in the application configuration
+    std::unique_ptr<AsyncArchiver> asyncArchiver_;
+
+    // Only present if archive.dedup is enabled in the application configuration
+    std::unique_ptr<Deduplicator> dedup_;
+
+    // Only present if archive.combine is specified in the application configuration
+    std::unique_ptr<WriteCombiner> combiner_;
+
+    // Only present if cache is specified (with a non-zero budget) in the application configuration
+    std::unique_ptr<CatalogueCache> cache_;
+
+    // Held by every use of fdb_ (see lockFDB() and lockArchive())
+    std::recursive_mutex archiveMutex_;
+
+    // Only present if flush is specified in the application configuration
+    std::unique_ptr<AutoFlush> autoFlush_;
+
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -252,6 +818,39 @@ void Dasi::archive(const Key& key, const void* data, size_t length) {
     impl_->archive(key, data, length);
 }
 
+void Dasi::archive(const Key& key, std::unique_ptr<eckit::Buffer> data) {
+    ASSERT(data);
+    ASSERT(impl_);
+    const size_t length = data->size();
+    impl_->archive(key, ArchiveData(std::move(data), length));
+}
+
+void Dasi::archive(const Key& key, const void* data, size_t length, std::function<void()> release) {
+    ArchiveData owned(data, length, std::move(release));
+    ASSERT(impl_);
+    impl_->archive(key, std::move(owned));
+}
+
+void Dasi::archive(const Key& key, eckit::DataHandle& handle) {
+    ASSERT(impl_);
+    impl_->archive(key, handle);
+}
+
+void Dasi::archiveBatch(const Key* const keys[], const void* const data[], const size_t lengths[], size_t count) {
+    ASSERT(impl_);
+    impl_->archiveBatch(keys, data, lengths, count);
+}
+
+ArchiveHandle Dasi::prepare(const Key& prefix) {
+    ASSERT(impl_);
+    return impl_->prepare(prefix);
+}
+
+ArchiveStream Dasi::archiveStream(const Key& key) {
+    ASSERT(impl_);
+    return impl_->archiveStream(key);
+}
+
 WipeGenerator Dasi::wipe(const Query& query, const bool doit, const bool porcelain, const bool all) {
     ASSERT(impl_);
     return impl_->wipe(query, doit, porcelain, all);
@@ -262,9 +861,19 @@ PurgeGenerator Dasi::purge(const Query& query, const bool doit, const bool porce
     return impl_->purge(query, doit, porcelain);
 }
 
-ListGenerator Dasi::list(const Query& query) {
+ListGenerator Dasi::list(const Query& query, const ListOptions& options) {
+    ASSERT(impl_);
+    return impl_->list(query, options);
+}
+
+size_t Dasi::count(const Query& query, const ListOptions& options) {
+    ASSERT(impl_);
+    return impl_->count(query, options);
+}
+
+Axes Dasi::axes(const Query& query, int level) {
     ASSERT(impl_);
-    return impl_->list(query);
+    return impl_->axes(query, level);
 }
 
 RetrieveResult Dasi::retrieve(const Query& query) {
@@ -292,6 +901,11 @@ void Dasi::dumpSchema(std::ostream& out) const {
     impl_->dumpSchema(out);
 }
 
+Stats Dasi::stats() const {
+    ASSERT(impl_);
+    return impl_->stats();
+}
+
     //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace dasi
@@ -16,12 +16,19 @@
 
 #include "dasi/api/Key.h"
 #include "dasi/api/Query.h"
+#include "dasi/api/detail/ArchiveDetail.h"
+#include "dasi/api/detail/AxesDetail.h"
 #include "dasi/api/detail/ListDetail.h"
 #include "dasi/api/detail/PurgeDetail.h"
 #include "dasi/api/detail/WipeDetail.h"
 #include "dasi/api/detail/PolicyDetail.h"
 #include "dasi/api/detail/RetrieveDetail.h"
+#include "dasi/api/detail/StatsDetail.h"
 
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+
+#include <functional>
 #include <memory>
 
 namespace dasi {
@@ -44,11 +51,63 @@ public: // methods
     /// Write data to be stored according to Dasi configuration
     /// @note After this call returns, Dasi has written this data to a backend or taken an internal copy. It is not
     ///       guaranteed accessible, or persisted wrt. failure, until flush() is called.
+    /// @note If archive.async is enabled in the application configuration, the data is copied into a staging
+    ///       buffer and written in the background. Errors are reported by a subsequent archive() or flush().
     /// @param key The metadata description of the data to store and index
     /// @param data A pointer to a (read-only) copy of the data
     /// @param length The length of the data to store in bytes
     void archive(const Key& key, const void* data, size_t length);
 
+    /// Write data to be stored according to Dasi configuration, transferring ownership of the buffer to Dasi
+    /// @note Dasi keeps the buffer until the data has been written, avoiding an internal copy when writing in the
+    ///       background (archive.async). Otherwise the same guarantees as archive() apply.
+    /// @param key The metadata description of the data to store and index
+    /// @param data The data to store. The full size of the buffer is stored.
+    void archive(const Key& key, std::unique_ptr<eckit::Buffer> data);
+
+    /// Write data to be stored according to Dasi configuration, transferring ownership of the memory to Dasi
+    /// @note Otherwise the same guarantees as archive() apply.
+    /// @param key The metadata description of the data to store and index
+    /// @param data A pointer to the data, which must remain valid and unmodified until release is called
+    /// @param length The length of the data to store in bytes
+    /// @param release Called exactly once when Dasi no longer needs the data (also on failure). This may be before
+    ///                archive() returns, and may be on another thread.
+    void archive(const Key& key, const void* data, size_t length, std::function<void()> release);
+
+    /// Write the contents of a data handle to be stored according to Dasi configuration
+    /// @note The handle is opened, read in fixed-size chunks that are written as they are read (see archiveStream()),
+    ///       and closed. Otherwise the same guarantees as archive() apply.
+    /// @throws eckit::ReadError if the handle fails to read
+    /// @param key The metadata description of the data to store and index
+    /// @param handle The (closed) data handle to read the data from
+    void archive(const Key& key, eckit::DataHandle& handle);
+
+    /// Write many data objects to be stored according to Dasi configuration, in one call
+    /// @note Same guarantees as archive(). The database of each entry is resolved against the schema once, for
+    ///       all the entries that share its first-level values, in whatever order they come. Converting the keys
+    ///       themselves is cheapest when entries with the same keywords are adjacent.
+    /// @param keys Array of pointers to the metadata description of each object
+    /// @param data Array of pointers to a (read-only) copy of each object
+    /// @param lengths Array of the lengths of each object in bytes
+    /// @param count The number of objects in the batch
+    void archiveBatch(const Key* const keys[], const void* const data[], const size_t lengths[], size_t count);
+
+    /// Prepare to archive many objects whose keys share a common prefix
+    /// @note The prefix is converted and resolved against the schema once, rather than for every object. This is
+    ///       intended for loops in which only the last-level keywords change.
+    /// @param prefix The keywords shared by all of the objects. Must specify at least the first-level keywords of
+    ///               the schema.
+    /// @returns A handle to archive objects with, which must not outlive this Dasi object
+    ArchiveHandle prepare(const Key& prefix);
+
+    /// Start archiving an object that is written in pieces, for objects too large to hold in memory
+    /// @note The pieces are written to the backend as they arrive, and the object is indexed when the stream is
+    ///       committed, with the same guarantees as archive(). Objects in spaces with compression are held
+    ///       compressed until then (see ArchiveStream).
+    /// @param key The metadata description of the data to store and index
+    /// @returns A stream to write the object to, which must not outlive this Dasi object
+    ArchiveStream archiveStream(const Key& key);
+
     /// Removes the data from Dasi up to 2nd-level rules.
     /// @note The data removal of 3rd-level rule is not possible.
     ///
@@ -86,9 +145,27 @@ public: // methods
 
     /// List data present and retrievable from the archive
     /// @param query A description of the span of metadata to list within
+    /// @param options The details of the objects to fill in, and which objects to list
     /// @returns An iterable generator object of ListElements, containing details of the objects found, the
     ///          keys describing them and a timestamp of object archival.
-    ListGenerator list(const Query& query);
+    ListGenerator list(const Query& query, const ListOptions& options = {});
+
+    /// Count the data present and retrievable from the archive, as list() would. This is much
+    /// cheaper than listing, as the details of each object are not built.
+    /// @param query A description of the span of metadata to count within
+    /// @param options Which objects to count, as for list(). A page is counted as it is listed:
+    ///                the objects after its cursor, up to its limit.
+    /// @returns The number of objects found
+    size_t count(const Query& query, const ListOptions& options = {});
+
+    /// The distinct values of each keyword of the data present in the archive. This is built from
+    /// the index metadata, without visiting each object, so covers the whole of each index that
+    /// matches the query.
+    /// @param query A description of the span of metadata to summarise
+    /// @param level The levels of the schema to summarise: 1 for only the database keywords, 2 to
+    ///              add the index keywords, or 3 (the default) for all the keywords
+    /// @returns The sorted values of each keyword
+    Axes axes(const Query& query, int level = 3);
 
     /// Set a named policy, or set of policies, for the data collections identified by the query
     /// @param query The data collections to modify
@@ -105,6 +182,12 @@ public: // methods
 
     void dumpSchema(std::ostream& out) const;
 
+    /// Counters and latency histograms for the operations made through this object since it was
+    /// created. Reads from the data handles of retrieve results are included.
+    ///
+    /// @returns A snapshot of the statistics
+    Stats stats() const;
+
     /// @note - move should follow same api and/or an ----- ioctl-type ----- api
 
 private: // members
@@ -1,30 +1,129 @@
 
 #include "Key.h"
 
+#include "dasi/impl/Fnv1a.h"
+#include "dasi/impl/KeyValueParser.h"
+
 #include "eckit/exception/Exceptions.h"
-#include "eckit/types/Types.h"
-#include "eckit/utils/StringTools.h"
+
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <shared_mutex>
+#include <sstream>
+#include <tuple>
 
 namespace dasi {
 
 //-------------------------------------------------------------------------------------------------
 
-Key::Key(std::initializer_list<std::pair<const std::string, std::string>> l) : values_(l) {}
+namespace {
+
+/// The process-wide table of interned keywords. Entries are never removed, so their addresses are
+/// stable. It is intentionally leaked, so that keys may be used during static destruction.
+
+class KeywordTable {
+
+public: // methods
+
+    static KeywordTable& instance() {
+        static auto* table = new KeywordTable;
+        return *table;
+    }
+
+    const std::string* intern(std::string_view name) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = atoms_.find(name);
+            if (it != atoms_.end()) return &*it;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        return &*atoms_.emplace(name).first;
+    }
+
+private: // members
+
+    std::shared_mutex mutex_;
+    std::set<std::string, std::less<>> atoms_;
+};
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+Keyword::Keyword() : Keyword(std::string_view{}) {}
+
+Keyword::Keyword(std::string_view name) : atom_(KeywordTable::instance().intern(name)) {}
+
+std::ostream& operator<<(std::ostream& s, const Keyword& k) {
+    return s << *k.atom_;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+Key::Key(std::initializer_list<std::pair<const std::string, std::string>> l) {
+    values_.reserve(l.size());
+    for (const auto& kv : l) { insert(kv.first, kv.second); }
+}
 
 Key::Key(const std::string& strKey) {
-    // TODO: Introduce a more robust parser
-    for (const std::string& bit : eckit::StringTools::split(",", strKey)) {
-        auto kvs = eckit::StringTools::split("=", bit);
-        if (kvs.size() != 2)
-            throw eckit::UserError("Invalid key supplied", Here());
-        if (kvs[1].find('/') != std::string::npos)
-            throw eckit::UserError("Query supplied when key required", Here());
-        values_.emplace(std::move(kvs[0]), std::move(kvs[1]));
+    KeyValueParser parser(strKey, "key", false);
+    std::string_view keyword;
+    std::string_view value;
+    while (parser.nextKeyword(keyword)) {
+        parser.nextValue(value);
+        insert(keyword, value);
     }
 }
 
+Key::Key(const Key& other) :
+    values_(other.values_), hash_(other.hash_.load(std::memory_order_relaxed)) {}
+
+Key::Key(Key&& other) noexcept :
+    values_(std::move(other.values_)), hash_(other.hash_.load(std::memory_order_relaxed)) {
+    other.hash_.store(0, std::memory_order_relaxed);
+}
+
+Key& Key::operator=(const Key& other) {
+    values_ = other.values_;
+    hash_.store(other.hash_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+Key& Key::operator=(Key&& other) noexcept {
+    values_ = std::move(other.values_);
+    hash_.store(other.hash_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.hash_.store(0, std::memory_order_relaxed);
+    return *this;
+}
+
 void Key::print(std::ostream& s) const {
-    s << values_;
+    s << "{";
+    const char* sep = "";
+    for (const auto& kv : values_) {
+        s << sep << kv.first << "=" << kv.second;
+        sep = ",";
+    }
+    s << "}";
+}
+
+Key::container_type::const_iterator Key::lowerBound(std::string_view name) const {
+    return std::lower_bound(values_.begin(), values_.end(), name,
+                            [](const auto& kv, std::string_view n) { return kv.first.str() < n; });
+}
+
+Key::container_type::const_iterator Key::find(std::string_view name) const {
+    auto it = lowerBound(name);
+    return (it != values_.end() && it->first == name) ? it : values_.end();
+}
+
+void Key::insert(std::string_view k, std::string_view v) {
+    auto it = lowerBound(k);
+    if (it == values_.end() || it->first != k) {
+        values_.emplace(it, std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(v));
+        hash_.store(0, std::memory_order_relaxed);
+    }
 }
 
 bool Key::has(const char* name) const {
@@ -32,41 +131,54 @@ bool Key::has(const char* name) const {
 }
 
 bool Key::has(const std::string_view& name) const {
-    return values_.find(name) != values_.end();
+    return find(name) != values_.end();
 }
 
 bool Key::has(const std::string& name) const {
-    return values_.find(name) != values_.end();
+    return find(name) != values_.end();
+}
+
+Key::const_iterator Key::set(const std::string& k, const value_type& v) {
+    auto pos = lowerBound(k);
+    auto it = values_.begin() + (pos - values_.cbegin());
+    hash_.store(0, std::memory_order_relaxed);
+    if (it != values_.end() && it->first == k) {
+        it->second = v;
+        return const_iterator(it);
+    }
+    return const_iterator(values_.emplace(it, Keyword(k), v));
 }
 
-Key::map_type::iterator Key::set(const std::string& k, const value_type& v) {
-    return values_.insert_or_assign(k, v).first;
+Key::const_iterator Key::set(std::string&& k, value_type&& v) {
+    auto pos = lowerBound(k);
+    auto it = values_.begin() + (pos - values_.cbegin());
+    hash_.store(0, std::memory_order_relaxed);
+    if (it != values_.end() && it->first == k) {
+        it->second = std::move(v);
+        return const_iterator(it);
+    }
+    return const_iterator(
+            values_.emplace(it, std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::move(v))));
 }
 
-Key::map_type::const_iterator Key::begin() const {
-    return values_.begin();
+Key::const_iterator Key::begin() const {
+    return const_iterator(values_.begin());
 }
 
-Key::map_type::const_iterator Key::end() const {
-    return values_.end();
+Key::const_iterator Key::end() const {
+    return const_iterator(values_.end());
 }
 
-Key::map_type::size_type Key::size() const {
+Key::size_type Key::size() const {
     return values_.size();
 }
 
 const Key::value_type& Key::get(const std::string& keyword) const {
-    auto it = values_.find(keyword);
-    if (it == values_.end()) {
-        std::ostringstream ss;
-        ss << keyword << " not found in Key";
-        throw eckit::UserError(ss.str(), Here());
-    }
-    return it->second;
+    return get(std::string_view(keyword));
 }
 
 const Key::value_type& Key::get(const std::string_view& keyword) const {
-    auto it = values_.find(keyword);
+    auto it = find(keyword);
     if (it == values_.end()) {
         std::ostringstream ss;
         ss << keyword << " not found in Key";
@@ -80,16 +192,14 @@ const Key::value_type& Key::get(const char* keyword) const {
 }
 
 void Key::erase(const std::string& k) {
-    auto it = values_.find(k);
-    if (it != values_.end()) {
-        values_.erase(it);
-    }
+    erase(std::string_view(k));
 }
 
 void Key::erase(const std::string_view& k) {
-    auto it = values_.find(k);
+    auto it = find(k);
     if (it != values_.end()) {
         values_.erase(it);
+        hash_.store(0, std::memory_order_relaxed);
     }
 }
 
@@ -99,6 +209,21 @@ void Key::erase(const char* k) {
 
 void Key::clear() {
     values_.clear();
+    hash_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Key::hash() const {
+    uint64_t h = hash_.load(std::memory_order_relaxed);
+    if (h == 0) {
+        h = fnv1aOffsetBasis;
+        for (const auto& kv : values_) {
+            h = fnv1a(h, kv.first.str());
+            h = fnv1a(h, kv.second);
+        }
+        // A hash of zero is recomputed each time, rather than cached
+        hash_.store(h, std::memory_order_relaxed);
+    }
+    return h;
 }
 
 bool Key::operator<(const Key& rhs) const {
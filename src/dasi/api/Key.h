@@ -4,18 +4,77 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
+#include <iosfwd>
+#include <iterator>
 #include <map>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 namespace dasi {
 
 //-------------------------------------------------------------------------------------------------
 
+/// A keyword, interned in a process-wide table. Keywords are drawn from a small vocabulary (that
+/// of the schema), so each distinct keyword is stored once, and keywords are equal if and only if
+/// they refer to the same entry. They are ordered by their text.
+
+class Keyword {
+
+public: // methods
+
+    Keyword();
+    explicit Keyword(std::string_view name);
+
+    [[ nodiscard ]]
+    const std::string& str() const { return *atom_; }
+    [[ nodiscard ]]
+    const char* c_str() const { return atom_->c_str(); }
+    [[ nodiscard ]]
+    size_t size() const { return atom_->size(); }
+
+    operator const std::string&() const { return *atom_; }
+
+    [[ nodiscard ]]
+    bool operator==(const Keyword& rhs) const { return atom_ == rhs.atom_; }
+    [[ nodiscard ]]
+    bool operator!=(const Keyword& rhs) const { return atom_ != rhs.atom_; }
+    [[ nodiscard ]]
+    bool operator<(const Keyword& rhs) const { return atom_ != rhs.atom_ && *atom_ < *rhs.atom_; }
+    [[ nodiscard ]]
+    bool operator>(const Keyword& rhs) const { return rhs < *this; }
+
+    [[ nodiscard ]]
+    bool operator==(std::string_view rhs) const { return *atom_ == rhs; }
+    [[ nodiscard ]]
+    bool operator!=(std::string_view rhs) const { return *atom_ != rhs; }
+
+private: // friends
+
+    friend std::ostream& operator<<(std::ostream& s, const Keyword& k);
+
+private: // members
+
+    const std::string* atom_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
 /// @note - This Key class can be made into a thinner wrapper of the FDB Key class, if required.
 ///         But it is currently written to be separable from the FDB.
+///
+/// The key:value pairs are held in a vector, sorted by keyword. Keys are small, so this is both
+/// more compact and faster to search, copy and compare than a node-based map. Values are
+/// std::strings, which hold short values inline.
+///
+/// Iteration presents the pairs as they were when held in a map_type, in keyword order, as pairs
+/// of std::strings. They are read-only, and are only modified through set().
 
 class Key {
 
@@ -25,12 +84,75 @@ public:
     /// @note use of transparent comparator --> allow lookup with std::string_view as key
     using map_type = std::map<std::string, value_type, std::less<>>;
 
+    using container_type = std::vector<std::pair<Keyword, value_type>>;
+
+    /// A read-only iterator over the key:value pairs. Elements are returned by a proxy pair of
+    /// references, so `it->first`, `kv.second` and structured bindings behave as for map_type.
+    class const_iterator {
+
+    public: // types
+
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = map_type::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const std::string&, const std::string&>;
+
+        struct pointer {
+            reference ref;
+            const reference* operator->() const { return &ref; }
+        };
+
+    public: // methods
+
+        const_iterator() = default;
+
+        reference operator*() const { return {it_->first.str(), it_->second}; }
+        pointer operator->() const { return {**this}; }
+
+        /// The interned keyword, which is cheaper to compare than its text
+        [[ nodiscard ]]
+        const Keyword& keyword() const { return it_->first; }
+
+        const_iterator& operator++() {
+            ++it_;
+            return *this;
+        }
+        const_iterator operator++(int) { return const_iterator(it_++); }
+        const_iterator& operator--() {
+            --it_;
+            return *this;
+        }
+        const_iterator operator--(int) { return const_iterator(it_--); }
+
+        [[ nodiscard ]]
+        bool operator==(const const_iterator& rhs) const { return it_ == rhs.it_; }
+        [[ nodiscard ]]
+        bool operator!=(const const_iterator& rhs) const { return it_ != rhs.it_; }
+
+    private: // methods
+
+        friend class Key;
+
+        explicit const_iterator(container_type::const_iterator it) : it_(it) {}
+
+    private: // members
+
+        container_type::const_iterator it_;
+    };
+
+    using size_type = container_type::size_type;
+
 public: // methods
 
     Key() = default;
     Key(std::initializer_list<std::pair<const std::string, std::string>>);
     explicit Key(const std::string& strKey);
 
+    Key(const Key& other);
+    Key(Key&& other) noexcept;
+    Key& operator=(const Key& other);
+    Key& operator=(Key&& other) noexcept;
+
     /** Is there a value corresponding to the specified key?
      * @param name The key to look up the corresponding value
      */
@@ -56,16 +178,26 @@ public: // methods
     /** Set the value corresponding to a specified key
      * @param k The key to set the value of
      * @param v The value to set
-     * @return An iterator to the pair<> corresponding to the just set/updated value
+     * @return A (read-only) iterator to the pair<> corresponding to the just set/updated value. It
+     *         is invalidated by any further modification of the key.
+     */
+    const_iterator set(const std::string& k, const value_type& v);
+    const_iterator set(std::string&& k, value_type&& v);
+
+    /** Insert a value, constructed in place from the arguments, if the keyword is not already
+     * present.
+     * @return A (read-only) iterator to the element for the keyword, and whether the value was
+     *         inserted
      */
-    typename map_type::iterator set(const std::string& k, const value_type& v);
+    template <typename... Args>
+    std::pair<const_iterator, bool> try_emplace(std::string_view k, Args&&... args);
 
     /** Constant iterator accessors to the key:value pairs stored */
-    typename map_type::const_iterator begin() const;
-    typename map_type::const_iterator end() const;
+    const_iterator begin() const;
+    const_iterator end() const;
 
     /** Return the number of key:value pairs stored */
-    typename map_type::size_type size() const;
+    size_type size() const;
 
     const value_type& get(const std::string& keyword) const;
     const value_type& get(const std::string_view& keyword) const;
@@ -81,8 +213,24 @@ public: // methods
     /** Erase all key:value pairs stored */
     void clear();
 
+    /** A 64-bit hash of the key:value pairs. It is cached until the key is modified, and is
+     * the same in every process (and on every platform), so may be used to partition work or
+     * as a persistent cache key.
+     */
+    [[ nodiscard ]]
+    uint64_t hash() const;
+
 private: // methods
 
+    /// The first element whose keyword is not less than the given name
+    [[ nodiscard ]]
+    container_type::const_iterator lowerBound(std::string_view name) const;
+    [[ nodiscard ]]
+    container_type::const_iterator find(std::string_view name) const;
+
+    /// Insert a value, if the keyword is not already present
+    void insert(std::string_view k, std::string_view v);
+
     /// TODO: It would be nice to have an elegant custom formatting
     void print(std::ostream& s) const;
 
@@ -95,9 +243,33 @@ private: // friends
 
 private: // members
 
-    map_type values_;
+    container_type values_;
+
+    // Zero if not yet computed
+    mutable std::atomic<uint64_t> hash_{0};
 };
 
 //-------------------------------------------------------------------------------------------------
 
+template <typename... Args>
+std::pair<Key::const_iterator, bool> Key::try_emplace(std::string_view k, Args&&... args) {
+    auto it = lowerBound(k);
+    if (it != values_.end() && it->first == k) return {const_iterator(it), false};
+    hash_.store(0, std::memory_order_relaxed);
+    it = values_.emplace(it, std::piecewise_construct, std::forward_as_tuple(k),
+                         std::forward_as_tuple(std::forward<Args>(args)...));
+    return {const_iterator(it), true};
+}
+
+//-------------------------------------------------------------------------------------------------
+
 } // namespace dasi
+
+namespace std {
+
+template <>
+struct hash<dasi::Key> {
+    size_t operator()(const dasi::Key& key) const noexcept { return static_cast<size_t>(key.hash()); }
+};
+
+}  // namespace std
@@ -1,8 +1,10 @@
 
 #include "Query.h"
 
+#include "dasi/impl/Fnv1a.h"
+#include "dasi/impl/KeyValueParser.h"
+
 #include "eckit/types/Types.h"
-#include "eckit/utils/StringTools.h"
 #include "eckit/exception/Exceptions.h"
 
 using namespace eckit;
@@ -16,15 +18,39 @@ Query::Query(std::initializer_list<std::pair<const std::string, std::vector<std:
         values_(l) {}
 
 Query::Query(const std::string& strKey) {
-    // TODO: Introduce a more robust parser
-    for (const std::string& bit : StringTools::split(",", strKey)) {
-        auto kvs = StringTools::split("=", bit);
-        if (kvs.size() != 2) throw UserError("Invalid key supplied", Here());
-        auto vals = StringTools::split("/", kvs[1]);
-        values_.emplace(std::move(kvs[0]), std::move(vals));
+    KeyValueParser parser(strKey, "query", true);
+    std::string_view keyword;
+    std::string_view value;
+    while (parser.nextKeyword(keyword)) {
+        // As for a key, the first occurrence of a keyword is kept
+        auto [it, inserted] = values_.try_emplace(std::string(keyword));
+        while (parser.nextValue(value)) {
+            if (inserted) { it->second.emplace_back(value); }
+        }
     }
 }
 
+Query::Query(const Query& other) :
+    values_(other.values_), hash_(other.hash_.load(std::memory_order_relaxed)) {}
+
+Query::Query(Query&& other) noexcept :
+    values_(std::move(other.values_)), hash_(other.hash_.load(std::memory_order_relaxed)) {
+    other.hash_.store(0, std::memory_order_relaxed);
+}
+
+Query& Query::operator=(const Query& other) {
+    values_ = other.values_;
+    hash_.store(other.hash_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+Query& Query::operator=(Query&& other) noexcept {
+    values_ = std::move(other.values_);
+    hash_.store(other.hash_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.hash_.store(0, std::memory_order_relaxed);
+    return *this;
+}
+
 void Query::print(std::ostream& s) const {
     s << values_;
 }
@@ -35,10 +61,22 @@ bool Query::has(const std::string_view& name) const {
 
 void Query::set(const std::string& k, std::initializer_list<std::string> v) {
     values_.insert_or_assign(k, v);
+    hash_.store(0, std::memory_order_relaxed);
 }
 
 void Query::set(const std::string& k, const value_type& v) {
     values_.insert_or_assign(k, v);
+    hash_.store(0, std::memory_order_relaxed);
+}
+
+void Query::set(std::string&& k, std::initializer_list<std::string> v) {
+    values_.insert_or_assign(std::move(k), v);
+    hash_.store(0, std::memory_order_relaxed);
+}
+
+void Query::set(std::string&& k, value_type&& v) {
+    values_.insert_or_assign(std::move(k), std::move(v));
+    hash_.store(0, std::memory_order_relaxed);
 }
 
 void Query::append(const std::string& k, const std::string& v) {
@@ -47,7 +85,8 @@ void Query::append(const std::string& k, const std::string& v) {
         set(k, {v});
         return;
     }
-    values_[k].push_back(v);
+    it->second.push_back(v);
+    hash_.store(0, std::memory_order_relaxed);
 }
 
 auto Query::get(const std::string_view& name) const -> const value_type& {
@@ -60,6 +99,10 @@ auto Query::get(const std::string_view& name) const -> const value_type& {
     return it->second;
 }
 
+QueryValues Query::expanded(const std::string_view& name) const {
+    return QueryValues(get(name));
+}
+
 Query::map_type::size_type Query::size() const {
     return values_.size();
 }
@@ -84,6 +127,7 @@ void Query::erase(const std::string& k) {
     auto it = values_.find(k);
     if (it != values_.end()) {
         values_.erase(it);
+        hash_.store(0, std::memory_order_relaxed);
     }
 }
 
@@ -91,6 +135,7 @@ void Query::erase(const std::string_view& k) {
     auto it = values_.find(k);
     if (it != values_.end()) {
         values_.erase(it);
+        hash_.store(0, std::memory_order_relaxed);
     }
 }
 
@@ -100,6 +145,29 @@ void Query::erase(const char* k) {
 
 void Query::clear() {
     values_.clear();
+    hash_.store(0, std::memory_order_relaxed);
+}
+
+bool Query::operator==(const Query& rhs) const {
+    return values_ == rhs.values_;
+}
+
+bool Query::operator!=(const Query& rhs) const {
+    return values_ != rhs.values_;
+}
+
+uint64_t Query::hash() const {
+    uint64_t h = hash_.load(std::memory_order_relaxed);
+    if (h == 0) {
+        h = fnv1aOffsetBasis;
+        for (const auto& kv : values_) {
+            h = fnv1a(h, kv.first);
+            for (const auto& value : kv.second) { h = fnv1a(h, value, 0x1f); }
+            h = fnv1a(h, std::string_view{}, 0x1e);
+        }
+        hash_.store(h, std::memory_order_relaxed);
+    }
+    return h;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -14,6 +14,11 @@
 
 #pragma once
 
+#include "dasi/api/detail/QueryValues.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <iosfwd>
 #include <map>
@@ -39,17 +44,37 @@ public: // methods
     Query(std::initializer_list<std::pair<const std::string, value_type>>);
     Query(const std::string& strKey);
 
+    Query(const Query& other);
+    Query(Query&& other) noexcept;
+    Query& operator=(const Query& other);
+    Query& operator=(Query&& other) noexcept;
+
     [[nodiscard]]
     bool has(const std::string_view& name) const;
 
     void set(const std::string& k, std::initializer_list<std::string> v);
     void set(const std::string& k, const value_type& v);
+    void set(std::string&& k, std::initializer_list<std::string> v);
+    void set(std::string&& k, value_type&& v);
+
+    /// Insert values, constructed in place from the arguments, if the keyword is not already
+    /// present. The returned iterator must not be used to modify the values (use set()).
+    /// @returns An iterator to the element for the keyword, and whether the values were inserted
+    template <typename... Args>
+    std::pair<map_type::iterator, bool> try_emplace(const std::string& k, Args&&... args);
+    template <typename... Args>
+    std::pair<map_type::iterator, bool> try_emplace(std::string&& k, Args&&... args);
 
     void append(const std::string& k, const std::string& v);
 
     map_type::size_type size() const;
     const value_type& get(const std::string_view& name) const;
 
+    /// The values of a keyword, with any ranges (`a/to/b/by/c`) expanded lazily. The query must
+    /// not be modified while the result is in use.
+    [[nodiscard]]
+    QueryValues expanded(const std::string_view& name) const;
+
     map_type::const_iterator begin() const;
     map_type::const_iterator end() const;
     map_type::const_iterator cbegin() const;
@@ -60,6 +85,16 @@ public: // methods
     void erase(const char* k);
     void clear();
 
+    [[nodiscard]]
+    bool operator==(const Query& rhs) const;
+    [[nodiscard]]
+    bool operator!=(const Query& rhs) const;
+
+    /// A 64-bit hash of the keywords and values. It is cached until the query is modified, and
+    /// is the same in every process (and on every platform).
+    [[nodiscard]]
+    uint64_t hash() const;
+
 private: // methods
 
     /// TODO: It would be nice to have a query-specific nice formatting
@@ -76,9 +111,35 @@ private: // members
 
     // n.b. use of transparent comparator --> allow lookup with std::string_view as key
     map_type values_;
+
+    // Zero if not yet computed
+    mutable std::atomic<uint64_t> hash_{0};
 };
 
 
+template <typename... Args>
+std::pair<Query::map_type::iterator, bool> Query::try_emplace(const std::string& k, Args&&... args) {
+    auto result = values_.try_emplace(k, std::forward<Args>(args)...);
+    if (result.second) { hash_.store(0, std::memory_order_relaxed); }
+    return result;
+}
+
+template <typename... Args>
+std::pair<Query::map_type::iterator, bool> Query::try_emplace(std::string&& k, Args&&... args) {
+    auto result = values_.try_emplace(std::move(k), std::forward<Args>(args)...);
+    if (result.second) { hash_.store(0, std::memory_order_relaxed); }
+    return result;
+}
+
 //-------------------------------------------------------------------------------------------------
 
 } // namespace dasi
+
+namespace std {
+
+template <>
+struct hash<dasi::Query> {
+    size_t operator()(const dasi::Query& query) const noexcept { return static_cast<size_t>(query.hash()); }
+};
+
+}  // namespace std
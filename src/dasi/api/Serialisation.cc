@@ -0,0 +1,305 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/api/Serialisation.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include <sstream>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Stream header: a magic byte, then the format version as a varint
+constexpr uint8_t magic = 0xda;
+constexpr uint64_t formatVersion = 1;
+
+enum RecordType : uint8_t {
+    KeyRecord = 1,
+    QueryRecord = 2,
+    ListElementRecord = 3
+};
+
+enum ListElementFlags : uint8_t {
+    HasChecksum = 0x1
+};
+
+// A varint holds at most 64 bits
+constexpr size_t maxVarintBytes = 10;
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+Encoder::Encoder() {
+    clear();
+}
+
+void Encoder::clear() {
+    buffer_.clear();
+    dictionary_.clear();
+    buffer_.push_back(static_cast<char>(magic));
+    putVarint(formatVersion);
+}
+
+void Encoder::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        buffer_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer_.push_back(static_cast<char>(value));
+}
+
+void Encoder::putString(std::string_view s) {
+    putVarint(s.size());
+    buffer_.append(s.data(), s.size());
+}
+
+void Encoder::putKeyword(std::string_view keyword) {
+    // 0 introduces a new keyword, which takes the next index. Otherwise it is the index + 1.
+    auto it = dictionary_.find(keyword);
+    if (it != dictionary_.end()) {
+        putVarint(it->second + 1);
+        return;
+    }
+    putVarint(0);
+    putString(keyword);
+    dictionary_.emplace(keyword, dictionary_.size());
+}
+
+void Encoder::putKey(const Key& key) {
+    putVarint(key.size());
+    for (const auto& kv : key) {
+        putKeyword(kv.first);
+        putString(kv.second);
+    }
+}
+
+void Encoder::encode(const Key& key) {
+    buffer_.push_back(static_cast<char>(KeyRecord));
+    putKey(key);
+}
+
+void Encoder::encode(const Query& query) {
+    buffer_.push_back(static_cast<char>(QueryRecord));
+    putVarint(query.size());
+    for (const auto& kv : query) {
+        putKeyword(kv.first);
+        putVarint(kv.second.size());
+        for (const auto& v : kv.second) { putString(v); }
+    }
+}
+
+void Encoder::encode(const ListElement& element) {
+    buffer_.push_back(static_cast<char>(ListElementRecord));
+    putKey(element.key);
+    putString(element.location.uri.asString());
+    putVarint(static_cast<long long>(element.location.offset));
+    putVarint(static_cast<long long>(element.location.length));
+    putVarint(zigzag(element.timestamp));
+    buffer_.push_back(static_cast<char>(element.checksum ? HasChecksum : 0));
+    if (element.checksum) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            buffer_.push_back(static_cast<char>((*element.checksum >> shift) & 0xff));
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+
+Decoder::Decoder(const void* data, size_t length) :
+    data_(static_cast<const char*>(data)),
+    length_(length) {
+
+    if (length_ == 0 || static_cast<uint8_t>(data_[0]) != magic) {
+        fail("not an encoded DASI stream");
+    }
+    pos_ = 1;
+    uint64_t version = getVarint();
+    if (version != formatVersion) {
+        std::ostringstream ss;
+        ss << "Unsupported encoding version " << version << " (expected " << formatVersion << ")";
+        throw eckit::UserError(ss.str(), Here());
+    }
+}
+
+void Decoder::fail(const char* message) const {
+    std::ostringstream ss;
+    ss << "Invalid encoded data: " << message << " at byte " << pos_;
+    throw eckit::UserError(ss.str(), Here());
+}
+
+void Decoder::expectRecord(uint8_t type) {
+    if (pos_ >= length_) fail("unexpected end of data");
+    if (static_cast<uint8_t>(data_[pos_]) != type) fail("unexpected record type");
+    ++pos_;
+}
+
+uint64_t Decoder::getVarint() {
+    uint64_t value = 0;
+    for (size_t i = 0; i < maxVarintBytes; ++i) {
+        if (pos_ >= length_) fail("unexpected end of data");
+        auto byte = static_cast<uint8_t>(data_[pos_++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80)) return value;
+    }
+    fail("varint too long");
+}
+
+std::string_view Decoder::getString() {
+    uint64_t len = getVarint();
+    if (len > length_ - pos_) fail("string overruns data");
+    std::string_view s(data_ + pos_, len);
+    pos_ += len;
+    return s;
+}
+
+const std::string& Decoder::getKeyword() {
+    uint64_t ref = getVarint();
+    if (ref == 0) {
+        std::string_view keyword = getString();
+        if (keyword.empty()) fail("empty keyword");
+        return dictionary_.emplace_back(keyword);
+    }
+    if (ref > dictionary_.size()) fail("unknown keyword reference");
+    return dictionary_[ref - 1];
+}
+
+void Decoder::getKey(Key& key) {
+    key.clear();
+    for (uint64_t n = getVarint(); n > 0; --n) {
+        const std::string& keyword = getKeyword();
+        std::string_view value = getString();
+        if (!key.try_emplace(keyword, value).second) fail("repeated keyword");
+    }
+}
+
+void Decoder::decode(Key& key) {
+    expectRecord(KeyRecord);
+    getKey(key);
+}
+
+Key Decoder::decodeKey() {
+    Key key;
+    decode(key);
+    return key;
+}
+
+Query Decoder::decodeQuery() {
+    expectRecord(QueryRecord);
+    Query query;
+    for (uint64_t n = getVarint(); n > 0; --n) {
+        const std::string& keyword = getKeyword();
+        uint64_t nvalues = getVarint();
+        if (nvalues > length_ - pos_) fail("value count overruns data");
+        Query::value_type values;
+        values.reserve(nvalues);
+        for (; nvalues > 0; --nvalues) { values.emplace_back(getString()); }
+        if (!query.try_emplace(keyword, std::move(values)).second) fail("repeated keyword");
+    }
+    return query;
+}
+
+void Decoder::decode(ListElement& element) {
+    expectRecord(ListElementRecord);
+    getKey(element.key);
+    element.location.uri = eckit::URI(std::string(getString()));
+    element.location.offset = static_cast<long long>(getVarint());
+    element.location.length = static_cast<long long>(getVarint());
+    element.timestamp = static_cast<time_t>(unzigzag(getVarint()));
+
+    if (pos_ >= length_) fail("unexpected end of data");
+    auto flags = static_cast<uint8_t>(data_[pos_++]);
+    if (flags & ~HasChecksum) fail("unknown flags");
+    element.checksum.reset();
+    if (flags & HasChecksum) {
+        if (length_ - pos_ < 4) fail("unexpected end of data");
+        uint32_t checksum = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            checksum |= static_cast<uint32_t>(static_cast<uint8_t>(data_[pos_++])) << shift;
+        }
+        element.checksum = checksum;
+    }
+}
+
+ListElement Decoder::decodeListElement() {
+    ListElement element;
+    decode(element);
+    return element;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+std::string encode(const Key& key) {
+    Encoder encoder;
+    encoder.encode(key);
+    return encoder.buffer();
+}
+
+std::string encode(const Query& query) {
+    Encoder encoder;
+    encoder.encode(query);
+    return encoder.buffer();
+}
+
+std::string encode(const ListElement& element) {
+    Encoder encoder;
+    encoder.encode(element);
+    return encoder.buffer();
+}
+
+namespace {
+
+template <typename T, typename Fn>
+T decodeOne(std::string_view data, Fn&& fn) {
+    Decoder decoder(data.data(), data.size());
+    T result = fn(decoder);
+    if (!decoder.done()) {
+        throw eckit::UserError("Invalid encoded data: trailing bytes after record", Here());
+    }
+    return result;
+}
+
+}  // namespace
+
+Key decodeKey(std::string_view data) {
+    return decodeOne<Key>(data, [](Decoder& d) { return d.decodeKey(); });
+}
+
+Query decodeQuery(std::string_view data) {
+    return decodeOne<Query>(data, [](Decoder& d) { return d.decodeQuery(); });
+}
+
+ListElement decodeListElement(std::string_view data) {
+    return decodeOne<ListElement>(data, [](Decoder& d) { return d.decodeListElement(); });
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/api/Key.h"
+#include "dasi/api/Query.h"
+#include "dasi/api/detail/ListDetail.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Compact binary encoding of keys, queries and list elements, for passing them between
+/// processes. A stream starts with a header (magic byte and format version), followed by any
+/// number of records. Integers are varints, and strings are length-prefixed. Each keyword is
+/// written in full the first time it appears in the stream, and by its index in a dictionary
+/// thereafter, so a stream of similar keys is mostly values.
+///
+/// The encoding is not self-describing: the reader must know what type of record comes next.
+
+class Encoder {
+
+public: // methods
+
+    Encoder();
+
+    void encode(const Key& key);
+    void encode(const Query& query);
+    void encode(const ListElement& element);
+
+    [[ nodiscard ]]
+    const std::string& buffer() const { return buffer_; }
+
+    /// Start a new stream, with an empty dictionary
+    void clear();
+
+private: // methods
+
+    void putVarint(uint64_t value);
+    void putString(std::string_view s);
+    void putKeyword(std::string_view keyword);
+    void putKey(const Key& key);
+
+private: // members
+
+    std::string buffer_;
+    std::map<std::string, uint64_t, std::less<>> dictionary_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+class Decoder {
+
+public: // methods
+
+    /// @throws eckit::UserError if the data is not an encoded stream of a supported version
+    Decoder(const void* data, size_t length);
+
+    [[ nodiscard ]]
+    Key decodeKey();
+    [[ nodiscard ]]
+    Query decodeQuery();
+    [[ nodiscard ]]
+    ListElement decodeListElement();
+
+    /// Decode into existing objects, reusing their storage
+    void decode(Key& key);
+    void decode(ListElement& element);
+
+    /// Have all the records been decoded?
+    [[ nodiscard ]]
+    bool done() const { return pos_ == length_; }
+
+private: // methods
+
+    void expectRecord(uint8_t type);
+    uint64_t getVarint();
+    std::string_view getString();
+    const std::string& getKeyword();
+    void getKey(Key& key);
+
+    [[ noreturn ]]
+    void fail(const char* message) const;
+
+private: // members
+
+    const char* data_;
+    size_t length_;
+    size_t pos_ = 0;
+    std::vector<std::string> dictionary_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+/// Encode a single object, as a stream of one record. Its keywords are written in full, so it is
+/// no smaller than the text form: the saving comes from encoding many objects into one stream.
+[[ nodiscard ]]
+std::string encode(const Key& key);
+[[ nodiscard ]]
+std::string encode(const Query& query);
+[[ nodiscard ]]
+std::string encode(const ListElement& element);
+
+[[ nodiscard ]]
+Key decodeKey(std::string_view data);
+[[ nodiscard ]]
+Query decodeQuery(std::string_view data);
+[[ nodiscard ]]
+ListElement decodeListElement(std::string_view data);
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -9,6 +9,7 @@
 
 #include "dasi_c.h"
 #include "dasi/api/Dasi.h"
+#include "dasi/api/Serialisation.h"
 #include "dasi/lib/dasi_version.h"
 
 #include "eckit/exception/Exceptions.h"
@@ -17,6 +18,10 @@
 
 #include <time.h>
 #include <functional>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
 
 extern "C" {
 
@@ -29,10 +34,12 @@ struct Dasi : public dasi::Dasi {
 struct Key : public dasi::Key {
     using dasi::Key::Key;
     Key(const dasi::Key& k) : dasi::Key(k) {}
+    Key(dasi::Key&& k) : dasi::Key(std::move(k)) {}
 };
 
 struct Query : public dasi::Query {
     using dasi::Query::Query;
+    Query(dasi::Query&& q) : dasi::Query(std::move(q)) {}
 };
 
 struct dasi_wipe_t {
@@ -53,14 +60,48 @@ struct dasi_purge_t {
     std::string                          value;
 };
 
+struct dasi_list_options_t {
+    dasi::ListOptions options;
+};
+
 struct dasi_list_t {
-    dasi_list_t(dasi::ListGenerator&& gen) :
-        first(true), generator(std::move(gen)), iterator(generator.begin()) {}
+    dasi_list_t(dasi::Dasi& dasi, const dasi::Query& query, const dasi::ListOptions& options) :
+        first(true),
+        dasi(dasi),
+        query(query),
+        options(options),
+        generator(dasi.list(query, options)),
+        iterator(generator.begin()) {}
 
     bool first;
+    // For dasi_list_count()
+    dasi::Dasi& dasi;
+    dasi::Query query;
+    dasi::ListOptions options;
+    mutable std::optional<long> count;
     dasi::ListGenerator generator;
     dasi::ListGenerator::const_iterator iterator;
-    std::string uri_cache;
+    // Only built if requested by dasi_list_attrs()
+    mutable std::optional<std::string> uri_cache;
+};
+
+struct dasi_axes_t {
+    explicit dasi_axes_t(dasi::Axes&& ax) : axes(std::move(ax)) {
+        keywords.reserve(axes.size());
+        for (const auto& kv : axes) { keywords.push_back(&kv.first); }
+    }
+
+    const std::vector<std::string>& values(const char* keyword) const {
+        auto it = axes.find(keyword);
+        if (it == axes.end()) {
+            throw eckit::UserError(std::string("Keyword not found in axes: ") + keyword, Here());
+        }
+        return it->second;
+    }
+
+    dasi::Axes axes;
+    // For access by index
+    std::vector<const std::string*> keywords;
 };
 
 struct dasi_retrieve_t {
@@ -73,6 +114,33 @@ struct dasi_retrieve_t {
     eckit::Optional<eckit::AutoClose> closer;
 };
 
+struct dasi_archive_handle_t {
+    dasi_archive_handle_t(dasi::ArchiveHandle&& h) : handle(std::move(h)) {}
+
+    dasi::ArchiveHandle handle;
+};
+
+struct dasi_archive_stream_t {
+    dasi_archive_stream_t(dasi::ArchiveStream&& s) : stream(std::move(s)) {}
+
+    dasi::ArchiveStream stream;
+};
+
+struct dasi_encoder_t {
+    dasi::Encoder encoder;
+};
+
+struct dasi_decoder_t {
+    dasi_decoder_t(const void* data, size_t length) :
+        data(static_cast<const char*>(data), length), decoder(this->data.data(), this->data.size()) {}
+
+    // The decoder refers to the copy of the data
+    const std::string data;
+    dasi::Decoder decoder;
+    dasi::ListElement element;
+    std::string uri;
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 //                           ERROR HANDLING
 
@@ -179,6 +247,14 @@ int dasi_open(dasi_t** dasi, const char* config) {
     });
 }
 
+int dasi_open_with_application_config(dasi_t** dasi, const char* config, const char* application_config) {
+    return tryCatch([dasi, config, application_config] {
+        ASSERT(dasi);
+        ASSERT(config);
+        *dasi = new Dasi(config, application_config);
+    });
+}
+
 int dasi_close(const dasi_t* dasi) {
     return tryCatch([dasi] {
         ASSERT(dasi);
@@ -197,6 +273,105 @@ int dasi_archive(dasi_t* dasi, const dasi_key_t* key, const void* data,
     });
 }
 
+int dasi_archive_owned(dasi_t* dasi, const dasi_key_t* key, void* data, long length, dasi_free_fn_t free_fn,
+                       void* user_data) {
+    // The release function is bound before anything else, so that it is called on every path
+    std::function<void()> release;
+    if (free_fn) {
+        release = [free_fn, data, user_data] { free_fn(data, user_data); };
+    }
+    return tryCatch([dasi, key, data, length, &release] {
+        if (!dasi || !key || !data || length < 0) {
+            if (release) { release(); }
+            ASSERT(dasi);
+            ASSERT(key);
+            ASSERT(data);
+            ASSERT(length >= 0);
+        }
+        dasi->archive(*key, data, length, std::move(release));
+    });
+}
+
+int dasi_archive_stream_open(dasi_t* dasi, const dasi_key_t* key, long length_hint, dasi_archive_stream_t** stream) {
+    return tryCatch([dasi, key, length_hint, stream] {
+        ASSERT(dasi);
+        ASSERT(key);
+        ASSERT(length_hint >= 0);
+        ASSERT(stream);
+        *stream = new dasi_archive_stream_t(dasi->archiveStream(*key));
+    });
+}
+
+int dasi_archive_stream_write(dasi_archive_stream_t* stream, const void* data, long length) {
+    return tryCatch([stream, data, length] {
+        ASSERT(stream);
+        ASSERT(data);
+        ASSERT(length >= 0);
+        stream->stream.write(data, length);
+    });
+}
+
+int dasi_archive_stream_commit(dasi_archive_stream_t* stream) {
+    return tryCatch([stream] {
+        ASSERT(stream);
+        stream->stream.commit();
+    });
+}
+
+int dasi_free_archive_stream(const dasi_archive_stream_t* stream) {
+    return tryCatch([stream] {
+        ASSERT(stream);
+        delete stream;
+    });
+}
+
+int dasi_prepare(dasi_t* dasi, const dasi_key_t* prefix, dasi_archive_handle_t** handle) {
+    return tryCatch([dasi, prefix, handle] {
+        ASSERT(dasi);
+        ASSERT(prefix);
+        ASSERT(handle);
+        *handle = new dasi_archive_handle_t(dasi->prepare(*prefix));
+    });
+}
+
+int dasi_prepared_archive(dasi_archive_handle_t* handle, const dasi_key_t* key, const void* data, long length) {
+    return tryCatch([handle, key, data, length] {
+        ASSERT(handle);
+        ASSERT(key);
+        ASSERT(data);
+        ASSERT(length >= 0);
+        handle->handle.archive(*key, data, length);
+    });
+}
+
+int dasi_free_archive_handle(const dasi_archive_handle_t* handle) {
+    return tryCatch([handle] {
+        ASSERT(handle);
+        delete handle;
+    });
+}
+
+int dasi_archive_batch(dasi_t* dasi, const dasi_key_t* const keys[], const void* const data[],
+                       const long lengths[], long count) {
+    return tryCatch([dasi, keys, data, lengths, count] {
+        ASSERT(dasi);
+        ASSERT(keys);
+        ASSERT(data);
+        ASSERT(lengths);
+        ASSERT(count >= 0);
+        std::vector<const dasi::Key*> dasiKeys(count);
+        std::vector<size_t> dasiLengths(count);
+        for (long i = 0; i < count; ++i) {
+            ASSERT(keys[i]);
+            ASSERT(data[i]);
+            ASSERT(lengths[i] >= 0);
+            dasiKeys[i] = keys[i];
+            dasiLengths[i] = lengths[i];
+        }
+        dasi->archiveBatch(dasiKeys.data(), data, dasiLengths.data(), count);
+    });
+}
+
 int dasi_wipe(dasi_t* dasi, const dasi_query_t* query, const dasi_bool_t* doit, const dasi_bool_t* all,
               dasi_wipe_t** wipe) {
     return tryCatch([dasi, query, doit, all, wipe] {
@@ -282,12 +457,34 @@ int dasi_flush(dasi_t* dasi) {
     });
 }
 
+int dasi_stats_json(const dasi_t* dasi, const char** json) {
+    return tryCatch([dasi, json] {
+        ASSERT(dasi);
+        ASSERT(json);
+        static thread_local std::string stats_json;
+        std::ostringstream ss;
+        dasi->stats().json(ss);
+        stats_json = ss.str();
+        *json = stats_json.c_str();
+    });
+}
+
 int dasi_list(dasi_t* dasi, const dasi_query_t* query, dasi_list_t** list) {
     return tryCatch([dasi, query, list] {
         ASSERT(dasi);
         ASSERT(query);
         ASSERT(list);
-        *list = new dasi_list_t(dasi->list(*query));
+        *list = new dasi_list_t(*dasi, *query, dasi::ListOptions{});
+    });
+}
+
+int dasi_list_with_options(dasi_t* dasi, const dasi_query_t* query, const dasi_list_options_t* options,
+                           dasi_list_t** list) {
+    return tryCatch([dasi, query, options, list] {
+        ASSERT(dasi);
+        ASSERT(query);
+        ASSERT(list);
+        *list = new dasi_list_t(*dasi, *query, options ? options->options : dasi::ListOptions{});
     });
 }
 
@@ -306,7 +503,7 @@ int dasi_list_next(dasi_list_t* list) {
         if (list->iterator == list->generator.end()) {
             return DASI_ITERATION_COMPLETE;
         }
-        list->uri_cache = list->iterator->location.uri.asRawString();
+        list->uri_cache.reset();
         return DASI_SUCCESS;
     }});
 }
@@ -319,18 +516,60 @@ int dasi_list_attrs(const dasi_list_t* list, dasi_key_t** key,
         ASSERT(list->iterator != list->generator.end());
         if (key) { *key = new Key(list->iterator->key); }
         if (timestamp) { *timestamp = list->iterator->timestamp; }
-        if (uri) { *uri = list->uri_cache.c_str(); }
+        if (uri) {
+            if (!list->uri_cache) {
+                const auto fields = list->options.fields;
+                list->uri_cache = (fields == dasi::ListFields::Locations || fields == dasi::ListFields::Full)
+                                          ? list->iterator->location.uri.asRawString()
+                                          : std::string{};
+            }
+            *uri = list->uri_cache->c_str();
+        }
         if (offset) { *offset = list->iterator->location.offset; }
         if (length) { *length = list->iterator->location.length; }
     });
 }
 
+int dasi_list_checksum(const dasi_list_t* list, dasi_bool_t* has_checksum, unsigned long* checksum) {
+    return tryCatch([list, has_checksum, checksum] {
+        ASSERT(list);
+        ASSERT(has_checksum);
+        ASSERT(list->iterator != list->generator.end());
+        const auto& value = list->iterator->checksum;
+        *has_checksum = value.has_value();
+        if (checksum) { *checksum = value.value_or(0); }
+    });
+}
+
+int dasi_list_encode(const dasi_list_t* list, const void** data, long* length) {
+    return tryCatch([list, data, length] {
+        ASSERT(list);
+        ASSERT(data);
+        ASSERT(length);
+        ASSERT(list->iterator != list->generator.end());
+        static thread_local std::string encoded;
+        encoded = dasi::encode(*list->iterator);
+        *data = encoded.data();
+        *length = encoded.size();
+    });
+}
+
+int dasi_list_cursor(const dasi_list_t* list, const char** cursor) {
+    return tryCatch([list, cursor] {
+        ASSERT(list);
+        ASSERT(cursor);
+        static thread_local std::string next;
+        next = list->generator.cursor();
+        *cursor = next.c_str();
+    });
+}
+
 int dasi_list_count(const dasi_list_t* list, long* count) {
     return tryCatch([list, count] {
         ASSERT(list);
         ASSERT(count);
-        throw eckit::NotImplemented("dasi_list_count is not implemented yet.",
-                                    Here());
+        if (!list->count) { list->count = static_cast<long>(list->dasi.count(list->query, list->options)); }
+        *count = list->count.value();
     });
 }
 
@@ -399,7 +638,19 @@ int dasi_retrieve_attrs(const dasi_retrieve_t* retrieve, dasi_key_t** key,
         if (key) { *key = new Key(retrieve->iterator->key); }
         if (timestamp) { *timestamp = retrieve->iterator->timestamp; }
         if (offset) { *offset = retrieve->iterator->location.offset; }
-        if (length) { *length = retrieve->iterator->location.length; }
+        // The length of the data as read, which may differ from that stored
+        if (length) { *length = retrieve->retrieve.dataLength(); }
+    });
+}
+
+int dasi_retrieve_checksum(const dasi_retrieve_t* retrieve, dasi_bool_t* has_checksum, unsigned long* checksum) {
+    return tryCatch([retrieve, has_checksum, checksum] {
+        ASSERT(retrieve);
+        ASSERT(has_checksum);
+        ASSERT(retrieve->iterator != retrieve->retrieve.end());
+        const auto value = retrieve->retrieve.checksum();
+        *has_checksum = value.has_value();
+        if (checksum) { *checksum = value.value_or(0); }
     });
 }
 
@@ -493,6 +744,143 @@ int dasi_key_clear(dasi_key_t* key) {
     });
 }
 
+int dasi_key_hash(const dasi_key_t* key, unsigned long long* hash) {
+    return tryCatch([key, hash] {
+        ASSERT(key);
+        ASSERT(hash);
+        *hash = key->hash();
+    });
+}
+
+int dasi_key_encode(const dasi_key_t* key, const void** data, long* length) {
+    return tryCatch([key, data, length] {
+        ASSERT(key);
+        ASSERT(data);
+        ASSERT(length);
+        static thread_local std::string encoded;
+        encoded = dasi::encode(*key);
+        *data = encoded.data();
+        *length = encoded.size();
+    });
+}
+
+int dasi_new_key_from_encoded(dasi_key_t** key, const void* data, long length) {
+    return tryCatch([key, data, length] {
+        ASSERT(key);
+        ASSERT(data);
+        ASSERT(length >= 0);
+        *key = new Key(dasi::decodeKey({static_cast<const char*>(data), static_cast<size_t>(length)}));
+    });
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// AXES
+
+int dasi_axes(dasi_t* dasi, const dasi_query_t* query, int level, dasi_axes_t** axes) {
+    return tryCatch([dasi, query, level, axes] {
+        ASSERT(dasi);
+        ASSERT(query);
+        ASSERT(axes);
+        *axes = new dasi_axes_t(dasi->axes(*query, level));
+    });
+}
+
+int dasi_free_axes(const dasi_axes_t* axes) {
+    return tryCatch([axes] {
+        ASSERT(axes);
+        delete axes;
+    });
+}
+
+int dasi_axes_keyword_count(const dasi_axes_t* axes, long* count) {
+    return tryCatch([axes, count] {
+        ASSERT(axes);
+        ASSERT(count);
+        *count = axes->keywords.size();
+    });
+}
+
+int dasi_axes_get_keyword(const dasi_axes_t* axes, long n, const char** keyword) {
+    return tryCatch([axes, n, keyword] {
+        ASSERT(axes);
+        ASSERT(keyword);
+        ASSERT(n >= 0 && static_cast<size_t>(n) < axes->keywords.size());
+        *keyword = axes->keywords[n]->c_str();
+    });
+}
+
+int dasi_axes_value_count(const dasi_axes_t* axes, const char* keyword, long* count) {
+    return tryCatch([axes, keyword, count] {
+        ASSERT(axes);
+        ASSERT(keyword);
+        ASSERT(count);
+        *count = axes->values(keyword).size();
+    });
+}
+
+int dasi_axes_get_value(const dasi_axes_t* axes, const char* keyword, long n, const char** value) {
+    return tryCatch([axes, keyword, n, value] {
+        ASSERT(axes);
+        ASSERT(keyword);
+        ASSERT(value);
+        const auto& values = axes->values(keyword);
+        ASSERT(n >= 0 && static_cast<size_t>(n) < values.size());
+        *value = values[n].c_str();
+    });
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// LIST OPTIONS
+
+int dasi_new_list_options(dasi_list_options_t** options) {
+    return tryCatch([options] {
+        ASSERT(options);
+        *options = new dasi_list_options_t();
+    });
+}
+
+int dasi_free_list_options(const dasi_list_options_t* options) {
+    return tryCatch([options] {
+        ASSERT(options);
+        delete options;
+    });
+}
+
+int dasi_list_options_set_fields(dasi_list_options_t* options, dasi_list_fields_t fields) {
+    return tryCatch([options, fields] {
+        ASSERT(options);
+        switch (fields) {
+            case DASI_LIST_KEYS:           options->options.fields = dasi::ListFields::Keys; break;
+            case DASI_LIST_KEYS_TIMESTAMP: options->options.fields = dasi::ListFields::KeysAndTimestamp; break;
+            case DASI_LIST_FULL:           options->options.fields = dasi::ListFields::Full; break;
+            case DASI_LIST_LOCATIONS:      options->options.fields = dasi::ListFields::Locations; break;
+            default: throw eckit::UserError("Unknown list fields " + std::to_string(fields), Here());
+        }
+    });
+}
+
+int dasi_list_options_set_since(dasi_list_options_t* options, dasi_time_t since) {
+    return tryCatch([options, since] {
+        ASSERT(options);
+        options->options.since = since;
+    });
+}
+
+int dasi_list_options_set_limit(dasi_list_options_t* options, long limit) {
+    return tryCatch([options, limit] {
+        ASSERT(options);
+        if (limit < 0) { throw eckit::UserError("List limit must not be negative", Here()); }
+        options->options.limit = static_cast<size_t>(limit);
+    });
+}
+
+int dasi_list_options_set_cursor(dasi_list_options_t* options, const char* cursor) {
+    return tryCatch([options, cursor] {
+        ASSERT(options);
+        options->options.cursor = cursor ? cursor : "";
+    });
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 // QUERY
 
@@ -590,6 +978,146 @@ int dasi_query_clear(dasi_query_t* query) {
     });
 }
 
+int dasi_query_encode(const dasi_query_t* query, const void** data, long* length) {
+    return tryCatch([query, data, length] {
+        ASSERT(query);
+        ASSERT(data);
+        ASSERT(length);
+        static thread_local std::string encoded;
+        encoded = dasi::encode(*query);
+        *data = encoded.data();
+        *length = encoded.size();
+    });
+}
+
+int dasi_new_query_from_encoded(dasi_query_t** query, const void* data, long length) {
+    return tryCatch([query, data, length] {
+        ASSERT(query);
+        ASSERT(data);
+        ASSERT(length >= 0);
+        *query = new Query(dasi::decodeQuery({static_cast<const char*>(data), static_cast<size_t>(length)}));
+    });
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// SERIALISATION
+
+int dasi_new_encoder(dasi_encoder_t** encoder) {
+    return tryCatch([encoder] {
+        ASSERT(encoder);
+        *encoder = new dasi_encoder_t;
+    });
+}
+
+int dasi_free_encoder(const dasi_encoder_t* encoder) {
+    return tryCatch([encoder] {
+        ASSERT(encoder);
+        delete encoder;
+    });
+}
+
+int dasi_encoder_add_key(dasi_encoder_t* encoder, const dasi_key_t* key) {
+    return tryCatch([encoder, key] {
+        ASSERT(encoder);
+        ASSERT(key);
+        encoder->encoder.encode(*key);
+    });
+}
+
+int dasi_encoder_add_query(dasi_encoder_t* encoder, const dasi_query_t* query) {
+    return tryCatch([encoder, query] {
+        ASSERT(encoder);
+        ASSERT(query);
+        encoder->encoder.encode(*query);
+    });
+}
+
+int dasi_encoder_add_list_element(dasi_encoder_t* encoder, const dasi_list_t* list) {
+    return tryCatch([encoder, list] {
+        ASSERT(encoder);
+        ASSERT(list);
+        ASSERT(list->iterator != list->generator.end());
+        encoder->encoder.encode(*list->iterator);
+    });
+}
+
+int dasi_encoder_buffer(const dasi_encoder_t* encoder, const void** data, long* length) {
+    return tryCatch([encoder, data, length] {
+        ASSERT(encoder);
+        ASSERT(data);
+        ASSERT(length);
+        *data = encoder->encoder.buffer().data();
+        *length = encoder->encoder.buffer().size();
+    });
+}
+
+int dasi_encoder_clear(dasi_encoder_t* encoder) {
+    return tryCatch([encoder] {
+        ASSERT(encoder);
+        encoder->encoder.clear();
+    });
+}
+
+int dasi_new_decoder(dasi_decoder_t** decoder, const void* data, long length) {
+    return tryCatch([decoder, data, length] {
+        ASSERT(decoder);
+        ASSERT(data);
+        ASSERT(length >= 0);
+        *decoder = new dasi_decoder_t(data, static_cast<size_t>(length));
+    });
+}
+
+int dasi_free_decoder(const dasi_decoder_t* decoder) {
+    return tryCatch([decoder] {
+        ASSERT(decoder);
+        delete decoder;
+    });
+}
+
+int dasi_decoder_done(const dasi_decoder_t* decoder, dasi_bool_t* done) {
+    return tryCatch([decoder, done] {
+        ASSERT(decoder);
+        ASSERT(done);
+        *done = decoder->decoder.done();
+    });
+}
+
+int dasi_decoder_next_key(dasi_decoder_t* decoder, dasi_key_t** key) {
+    return tryCatch([decoder, key] {
+        ASSERT(decoder);
+        ASSERT(key);
+        *key = new Key(decoder->decoder.decodeKey());
+    });
+}
+
+int dasi_decoder_next_query(dasi_decoder_t* decoder, dasi_query_t** query) {
+    return tryCatch([decoder, query] {
+        ASSERT(decoder);
+        ASSERT(query);
+        *query = new Query(decoder->decoder.decodeQuery());
+    });
+}
+
+int dasi_decoder_next_list_element(dasi_decoder_t* decoder, dasi_key_t** key, dasi_time_t* timestamp,
+                                   const char** uri, long* offset, long* length, dasi_bool_t* has_checksum,
+                                   unsigned long* checksum) {
+    return tryCatch([decoder, key, timestamp, uri, offset, length, has_checksum, checksum] {
+        ASSERT(decoder);
+        auto& element = decoder->element;
+        decoder->decoder.decode(element);
+        if (key) { *key = new Key(element.key); }
+        if (timestamp) { *timestamp = element.timestamp; }
+        if (uri) {
+            decoder->uri = element.location.uri.asRawString();
+            *uri = decoder->uri.c_str();
+        }
+        if (offset) { *offset = element.location.offset; }
+        if (length) { *length = element.location.length; }
+        if (has_checksum) { *has_checksum = element.checksum.has_value(); }
+        if (checksum) { *checksum = element.checksum.value_or(0); }
+    });
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 
 }  // extern "C"
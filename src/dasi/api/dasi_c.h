@@ -40,6 +40,9 @@ typedef int dasi_bool_t;
 /** DASI time type */
 typedef long dasi_time_t;
 
+/** Function releasing data whose ownership has been transferred to DASI */
+typedef void (*dasi_free_fn_t)(void* data, void* user_data);
+
 struct Dasi;
 /** DASI instance type */
 typedef struct Dasi dasi_t;
@@ -64,10 +67,42 @@ struct dasi_list_t;
 /** DASI list type */
 typedef struct dasi_list_t dasi_list_t;
 
+struct dasi_list_options_t;
+/** DASI list options type */
+typedef struct dasi_list_options_t dasi_list_options_t;
+
+/** The details filled in for each element of a list */
+typedef enum dasi_list_fields_t {
+    DASI_LIST_KEYS           = 0, /* Only the keys */
+    DASI_LIST_KEYS_TIMESTAMP = 1, /* The keys and archive timestamps */
+    DASI_LIST_FULL           = 2, /* Everything, including the decoded lengths and checksums of the data */
+    DASI_LIST_LOCATIONS      = 3  /* The keys, timestamps and locations of the data as stored, without reading it */
+} dasi_list_fields_t;
+
+struct dasi_axes_t;
+/** DASI axes type */
+typedef struct dasi_axes_t dasi_axes_t;
+
 struct dasi_retrieve_t;
 /** DASI retrieve type */
 typedef struct dasi_retrieve_t dasi_retrieve_t;
 
+struct dasi_archive_handle_t;
+/** DASI prepared archive type */
+typedef struct dasi_archive_handle_t dasi_archive_handle_t;
+
+struct dasi_archive_stream_t;
+/** DASI streaming archive type */
+typedef struct dasi_archive_stream_t dasi_archive_stream_t;
+
+struct dasi_encoder_t;
+/** DASI binary stream encoder type */
+typedef struct dasi_encoder_t dasi_encoder_t;
+
+struct dasi_decoder_t;
+/** DASI binary stream decoder type */
+typedef struct dasi_decoder_t dasi_decoder_t;
+
 /* ---------------------------------------------------------------------------------------------------------------------
  * ERROR HANDLING
  * -------------- */
@@ -126,6 +161,16 @@ int dasi_initialise_api(void);
  */
 int dasi_open(dasi_t** dasi, const char* config);
 
+/**
+ * Creates a new dasi object, with an application configuration that controls the behaviour of this
+ * session (e.g. asynchronous archive, or the automatic flush policy).
+ * @param dasi output dasi object
+ * @param config input file or string to dasi configuration (yaml format)
+ * @param application_config application configuration (yaml format), or NULL for the defaults
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_open_with_application_config(dasi_t** dasi, const char* config, const char* application_config);
+
 /**
  * Deletes the dasi object.
  * @param dasi object to delete
@@ -147,21 +192,198 @@ int dasi_close(const dasi_t* dasi);
  */
 int dasi_archive(dasi_t* dasi, const dasi_key_t* key, const void* data, long length);
 
+/**
+ * Writes data to the object store, transferring ownership of the data to DASI.
+ *
+ * @note Avoids an internal copy of the data when it is written in the
+ * background. Otherwise the same guarantees as dasi_archive() apply.
+ *
+ * @param dasi dasi object
+ * @param key Metadata description of the data to store and index
+ * @param data Pointer to the data. It must remain valid and unmodified until
+ * free_fn is called.
+ * @param length Length of "data" in bytes
+ * @param free_fn Called exactly once as free_fn(data, user_data) when DASI no
+ * longer needs the data, also if an error occurs. This may happen before the
+ * function returns, and may be on another thread. May be NULL.
+ * @param user_data Passed through to free_fn
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_archive_owned(dasi_t* dasi, const dasi_key_t* key, void* data, long length, dasi_free_fn_t free_fn,
+                       void* user_data);
+
+/**
+ * Starts writing a data object to the object store in pieces.
+ *
+ * @note The pieces are written as they arrive, so the object is not held in
+ * memory in full (except as noted for dasi::ArchiveStream), but it is only
+ * indexed by dasi_archive_stream_commit(). Deleting the stream with
+ * dasi_free_archive_stream() before committing discards it.
+ *
+ * @param dasi dasi object
+ * @param key Metadata description of the data to store and index
+ * @param length_hint Expected total length in bytes, or zero if unknown.
+ * Unused, as the object is no longer staged in memory.
+ * @param stream new streaming archive object
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_archive_stream_open(dasi_t* dasi, const dasi_key_t* key, long length_hint, dasi_archive_stream_t** stream);
+
+/**
+ * Appends a chunk of data to the object being written.
+ * @param stream streaming archive object
+ * @param data Pointer to the read-only chunk of data
+ * @param length Length of "data" in bytes
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_archive_stream_write(dasi_archive_stream_t* stream, const void* data, long length);
+
+/**
+ * Writes the completed object to the object store, with the same guarantees
+ * as dasi_archive(). The stream cannot be written to afterwards.
+ * @param stream streaming archive object
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_archive_stream_commit(dasi_archive_stream_t* stream);
+
+/**
+ * Frees a streaming archive object. If it has not been committed, the data
+ * written to it is discarded.
+ * @param stream streaming archive object
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_free_archive_stream(const dasi_archive_stream_t* stream);
+
+/**
+ * Prepares to write many data objects whose keys share a common prefix.
+ *
+ * @note The prefix is converted and resolved against the schema once, rather
+ * than for every object. The handle must be deleted before the dasi object.
+ *
+ * @param dasi dasi object
+ * @param prefix Keywords shared by all of the objects. Must specify at least
+ * the first-level keywords of the schema.
+ * @param handle new prepared archive object
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_prepare(dasi_t* dasi, const dasi_key_t* prefix, dasi_archive_handle_t** handle);
+
+/**
+ * Writes data to the object store using a prepared prefix, with the same
+ * guarantees as dasi_archive().
+ * @param handle prepared archive object
+ * @param key Keywords completing the prefix. May not repeat keywords of the
+ * prefix.
+ * @param data Pointer to the read-only data
+ * @param length Length of "data" in bytes
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_prepared_archive(dasi_archive_handle_t* handle, const dasi_key_t* key, const void* data, long length);
+
+int dasi_free_archive_handle(const dasi_archive_handle_t* handle);
+
+/**
+ * Writes many data objects to the object store in one call.
+ *
+ * @note Same guarantees as dasi_archive(). Ordering the batch such that
+ * similar keys are adjacent makes the call cheaper.
+ *
+ * @param dasi dasi object
+ * @param keys Array of "count" metadata descriptions
+ * @param data Array of "count" pointers to the read-only data
+ * @param lengths Array of "count" lengths of "data" in bytes
+ * @param count Number of objects in the batch
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_archive_batch(dasi_t* dasi, const dasi_key_t* const keys[], const void* const data[], const long lengths[],
+                       long count);
+
 int dasi_flush(dasi_t* dasi);
 
+/**
+ * Gets the operation statistics of a dasi session (call counts, bytes, total
+ * times and latency histograms), as a JSON document.
+ * @param dasi dasi object
+ * @param json JSON string. DO NOT modify/free the returned pointer. It remains
+ * valid until the next call of dasi_stats_json() on the same thread.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_stats_json(const dasi_t* dasi, const char** json);
+
 /* List functionality */
 
 int dasi_list(dasi_t* dasi, const dasi_query_t* query, dasi_list_t** list);
 
+/**
+ * Lists data present and retrievable from the archive, as dasi_list().
+ * @param dasi dasi object
+ * @param query metadata description of the data
+ * @param options the details to list, or NULL for the defaults
+ * @param list new list object. Returned value must be freed via dasi_free_...
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_list_with_options(dasi_t* dasi, const dasi_query_t* query, const dasi_list_options_t* options,
+                           dasi_list_t** list);
+
 int dasi_free_list(const dasi_list_t* list);
 
+/**
+ * Counts the elements of a list, without iterating over them. The count is
+ * made when first requested, and does not change as the list is iterated.
+ * A paged list is counted as one page: the elements after its cursor, up to its limit.
+ * @param list list object
+ * @param count number of elements in the list
+ * @return dasi error code, see dasi_error_enum_t.
+ */
 int dasi_list_count(const dasi_list_t* list, long* count);
 
 int dasi_list_next(dasi_list_t* list);
 
+/**
+ * Gets the details of the current element of a list. Details that were not
+ * requested in the list options are zero (or an empty uri).
+ * @param list list object
+ * @param key new key object, if not NULL. Returned value must be freed via dasi_free_...
+ * @param timestamp time of archival, if not NULL
+ * @param uri location of the data, if not NULL. DO NOT modify/free the returned pointer.
+ * @param offset offset of the data, if not NULL
+ * @param length length of the data, if not NULL
+ * @return dasi error code, see dasi_error_enum_t.
+ */
 int dasi_list_attrs(const dasi_list_t* list, dasi_key_t** key, dasi_time_t* timestamp, const char** uri, long* offset,
                     long* length);
 
+/**
+ * Gets the checksum of the current element of a list.
+ * @param list list object
+ * @param has_checksum set to true if the object was archived with a checksum
+ * @param checksum CRC-32C of the data, if there is one
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_list_checksum(const dasi_list_t* list, dasi_bool_t* has_checksum, unsigned long* checksum);
+
+/**
+ * Encodes the current element of a list in the compact binary form, see
+ * dasi_key_encode().
+ * @param list list object
+ * @param data pointer to the encoded element.
+ * DO NOT modify/free the returned pointer. It is valid until the next call.
+ * @param length length of the encoded element in bytes
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_list_encode(const dasi_list_t* list, const void** data, long* length);
+
+/**
+ * Gets the cursor from which to continue a paged list, after the current element (or after the
+ * last, once the iteration is complete). Only available if a limit or cursor was set in the list
+ * options.
+ * @param list list object
+ * @param cursor the cursor, or an empty string if there are no more elements.
+ * DO NOT modify/free the returned pointer. It is valid until the next call.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_list_cursor(const dasi_list_t* list, const char** cursor);
+
 /* Retrieve functionality */
 
 int dasi_retrieve(dasi_t* dasi, const dasi_query_t* query, dasi_retrieve_t** retrieve);
@@ -174,9 +396,19 @@ int dasi_retrieve_count(const dasi_retrieve_t* retrieve, long* count);
 
 int dasi_retrieve_next(dasi_retrieve_t* retrieve);
 
+/**
+ * Gets the attributes of the current element of a retrieve. Each output may be NULL if not needed.
+ * The length is that of the data as read by dasi_retrieve_read(). If the object is compressed or
+ * checksummed, asking for it reads the start of the object.
+ */
 int dasi_retrieve_attrs(const dasi_retrieve_t* retrieve, dasi_key_t** key, dasi_time_t* timestamp, long* offset,
                         long* length);
 
+/**
+ * Gets the checksum of the current element of a retrieve, see dasi_list_checksum().
+ */
+int dasi_retrieve_checksum(const dasi_retrieve_t* retrieve, dasi_bool_t* has_checksum, unsigned long* checksum);
+
 /* Wipe functionality */
 
 /**
@@ -281,6 +513,118 @@ int dasi_key_erase(dasi_key_t* key, const char* keyword);
 /** Erase all elements in the key */
 int dasi_key_clear(dasi_key_t* key);
 
+/**
+ * Gets a 64-bit hash of the key. It is the same in every process, and on every
+ * platform, so may be used to partition work or as a persistent cache key.
+ * @param key input key.
+ * @param hash the hash.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_key_hash(const dasi_key_t* key, unsigned long long* hash);
+
+/**
+ * Encodes the key in a compact, versioned binary form, for passing it to
+ * another process. It is decoded by dasi_new_key_from_encoded(). A single key
+ * carries its keywords in full, so is no smaller than the text form: to pass
+ * many keys, encode them into one stream with dasi_new_encoder().
+ * @param key input key.
+ * @param data pointer to the encoded key.
+ * DO NOT modify/free the returned pointer. It is valid until the next call.
+ * @param length length of the encoded key in bytes
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_key_encode(const dasi_key_t* key, const void** data, long* length);
+
+/**
+ * Constructs a new dasi key object from its binary form (see dasi_key_encode()).
+ * @param key pointer to new object. Returned value must be freed via dasi_free_...
+ * @param data the encoded key
+ * @param length length of "data" in bytes
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_new_key_from_encoded(dasi_key_t** key, const void* data, long length);
+
+/* Axes functionality */
+
+/**
+ * Gets the distinct values of each keyword of the data present in the archive.
+ * They are built from the index metadata, so cover the whole of each index
+ * that matches the query.
+ * @param dasi dasi object
+ * @param query metadata description of the data
+ * @param level 1: database keywords only, 2: add the index keywords, 3: all
+ * @param axes new axes object. Returned value must be freed via dasi_free_...
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_axes(dasi_t* dasi, const dasi_query_t* query, int level, dasi_axes_t** axes);
+
+int dasi_free_axes(const dasi_axes_t* axes);
+
+int dasi_axes_keyword_count(const dasi_axes_t* axes, long* count);
+
+/**
+ * Gets the n-th keyword of the axes, in sorted order.
+ * @param keyword DO NOT modify/free the returned pointer.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_axes_get_keyword(const dasi_axes_t* axes, long n, const char** keyword);
+
+int dasi_axes_value_count(const dasi_axes_t* axes, const char* keyword, long* count);
+
+/**
+ * Gets the n-th value of a keyword, in sorted order.
+ * @param value DO NOT modify/free the returned pointer.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_axes_get_value(const dasi_axes_t* axes, const char* keyword, long n, const char** value);
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ * LIST OPTIONS
+ * ------------ */
+
+/**
+ * Constructs a new list options object, with the defaults (a full listing).
+ * @param options pointer to new object. Returned value must be freed via dasi_free_...
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_new_list_options(dasi_list_options_t** options);
+
+int dasi_free_list_options(const dasi_list_options_t* options);
+
+/**
+ * Selects the details filled in for each element of a list.
+ * @param options list options object
+ * @param fields the details, see dasi_list_fields_t
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_list_options_set_fields(dasi_list_options_t* options, dasi_list_fields_t fields);
+
+/**
+ * Only lists the objects archived at or after a time, for polling for new data. Times are only
+ * recorded to the second, so the objects archived in the second given are listed again.
+ * @param options list options object
+ * @param since seconds since the epoch, as returned by dasi_list_attrs
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_list_options_set_since(dasi_list_options_t* options, dasi_time_t since);
+
+/**
+ * Lists at most a number of elements, as a page. The next page is listed by
+ * setting the cursor from dasi_list_cursor().
+ * @param options list options object
+ * @param limit the maximum number of elements, or 0 for no limit
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_list_options_set_limit(dasi_list_options_t* options, long limit);
+
+/**
+ * Continues a paged list from a cursor.
+ * @param options list options object
+ * @param cursor a cursor from dasi_list_cursor(), or NULL or empty to start from the beginning
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_list_options_set_cursor(dasi_list_options_t* options, const char* cursor);
+
 /* ---------------------------------------------------------------------------------------------------------------------
  * QUERY
  * ----- */
@@ -307,6 +651,103 @@ int dasi_query_erase(dasi_query_t* query, const char* keyword);
 
 int dasi_query_clear(dasi_query_t* query);
 
+/**
+ * Encodes the query in a compact, versioned binary form, see dasi_key_encode().
+ * DO NOT modify/free the returned pointer. It is valid until the next call.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_query_encode(const dasi_query_t* query, const void** data, long* length);
+
+/**
+ * Constructs a new dasi query object from its binary form (see dasi_query_encode()).
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_new_query_from_encoded(dasi_query_t** query, const void* data, long length);
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ * SERIALISATION
+ * ------------- */
+
+/**
+ * Constructs a new encoder, which writes keys, queries and list elements into one binary stream.
+ * Each keyword is written in full only the first time it appears, so a stream of similar keys is
+ * much smaller than encoding them one at a time (see dasi_key_encode()).
+ * @param encoder pointer to new object. Returned value must be freed via dasi_free_...
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_new_encoder(dasi_encoder_t** encoder);
+
+int dasi_free_encoder(const dasi_encoder_t* encoder);
+
+int dasi_encoder_add_key(dasi_encoder_t* encoder, const dasi_key_t* key);
+
+int dasi_encoder_add_query(dasi_encoder_t* encoder, const dasi_query_t* query);
+
+/**
+ * Adds the current element of a list to the stream.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_encoder_add_list_element(dasi_encoder_t* encoder, const dasi_list_t* list);
+
+/**
+ * Gets the stream encoded so far.
+ * @param encoder encoder object
+ * @param data pointer to the stream.
+ * DO NOT modify/free the returned pointer. It is valid until the encoder is next modified.
+ * @param length length of the stream in bytes
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_encoder_buffer(const dasi_encoder_t* encoder, const void** data, long* length);
+
+/**
+ * Starts a new stream, so that the next is independent of what has been encoded so far.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_encoder_clear(dasi_encoder_t* encoder);
+
+/**
+ * Constructs a new decoder, for a stream written by an encoder (or by any of the dasi_*_encode()
+ * functions). The records must be decoded as the same types, in the same order, as they were
+ * encoded.
+ * @param decoder pointer to new object. Returned value must be freed via dasi_free_...
+ * @param data the stream, which is copied
+ * @param length length of "data" in bytes
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_new_decoder(dasi_decoder_t** decoder, const void* data, long length);
+
+int dasi_free_decoder(const dasi_decoder_t* decoder);
+
+/**
+ * Checks whether every record in the stream has been decoded.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_decoder_done(const dasi_decoder_t* decoder, dasi_bool_t* done);
+
+/**
+ * Decodes the next record, which must be a key.
+ * @param key pointer to new object. Returned value must be freed via dasi_free_...
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_decoder_next_key(dasi_decoder_t* decoder, dasi_key_t** key);
+
+/**
+ * Decodes the next record, which must be a query.
+ * @param query pointer to new object. Returned value must be freed via dasi_free_...
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_decoder_next_query(dasi_decoder_t* decoder, dasi_query_t** query);
+
+/**
+ * Decodes the next record, which must be a list element. The details are as for dasi_list_attrs()
+ * and dasi_list_checksum(), and may each be NULL if not needed.
+ * @param uri DO NOT modify/free the returned pointer. It is valid until the next call.
+ * @return dasi error code, see dasi_error_enum_t.
+ */
+int dasi_decoder_next_list_element(dasi_decoder_t* decoder, dasi_key_t** key, dasi_time_t* timestamp,
+                                   const char** uri, long* offset, long* length, dasi_bool_t* has_checksum,
+                                   unsigned long* checksum);
+
 /* -------------------------------------------------------------------------------------------------------------------*/
 
 #ifdef __cplusplus
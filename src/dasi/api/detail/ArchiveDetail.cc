@@ -0,0 +1,53 @@
+
+#include "dasi/api/detail/ArchiveDetail.h"
+
+#include "dasi/impl/ArchiveHandleImpl.h"
+#include "dasi/impl/ArchiveStreamImpl.h"
+
+#include "eckit/exception/Exceptions.h"
+
+namespace dasi {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ArchiveHandle::ArchiveHandle(std::unique_ptr<ArchiveHandleImpl>&& impl) : impl_(std::move(impl)) {}
+
+ArchiveHandle::ArchiveHandle(ArchiveHandle&& rhs) noexcept = default;
+
+ArchiveHandle& ArchiveHandle::operator=(ArchiveHandle&& rhs) noexcept = default;
+
+ArchiveHandle::~ArchiveHandle() = default;
+
+void ArchiveHandle::archive(const Key& leaf, const void* data, size_t length) {
+    ASSERT(impl_);
+    impl_->archive(leaf, data, length);
+}
+
+const Key& ArchiveHandle::prefix() const {
+    ASSERT(impl_);
+    return impl_->prefix();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ArchiveStream::ArchiveStream(std::unique_ptr<ArchiveStreamImpl>&& impl) : impl_(std::move(impl)) {}
+
+ArchiveStream::ArchiveStream(ArchiveStream&& rhs) noexcept = default;
+
+ArchiveStream& ArchiveStream::operator=(ArchiveStream&& rhs) noexcept = default;
+
+ArchiveStream::~ArchiveStream() = default;
+
+void ArchiveStream::write(const void* data, size_t length) {
+    ASSERT(impl_);
+    impl_->write(data, length);
+}
+
+size_t ArchiveStream::commit() {
+    ASSERT(impl_);
+    return impl_->commit();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/api/Key.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+class ArchiveHandleImpl;
+
+/// A handle for archiving many objects that share a common key prefix, as returned by
+/// Dasi::prepare(). The prefix is converted and resolved against the schema once, so each
+/// archive() only does the work for the remaining (leaf) keywords.
+///
+/// @note The handle must not outlive the Dasi object that created it.
+
+class ArchiveHandle {
+
+public: // methods
+
+    explicit ArchiveHandle(std::unique_ptr<ArchiveHandleImpl>&& impl);
+
+    ArchiveHandle(ArchiveHandle&& rhs) noexcept;
+    ArchiveHandle& operator=(ArchiveHandle&& rhs) noexcept;
+
+    ~ArchiveHandle();
+
+    /// Write data to be stored, with the same guarantees as Dasi::archive()
+    /// @param leaf The keywords completing the prefix. These may not repeat keywords of the prefix.
+    /// @param data A pointer to a (read-only) copy of the data
+    /// @param length The length of the data to store in bytes
+    void archive(const Key& leaf, const void* data, size_t length);
+
+    [[ nodiscard ]]
+    const Key& prefix() const;
+
+private: // members
+
+    std::unique_ptr<ArchiveHandleImpl> impl_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+class ArchiveStreamImpl;
+
+/// An object being archived in pieces, as returned by Dasi::archiveStream(). The pieces are written
+/// as they arrive, so the object is not held in memory in full, and the object is indexed by
+/// commit(), with the same guarantees as Dasi::archive(). Nothing is indexed if it is not committed.
+///
+/// @note In a space with compression, the compressed object is held until it is committed. In a
+///       space with checksums but no compression, the whole object is held.
+/// @note The stream must not outlive the Dasi object that created it.
+
+class ArchiveStream {
+
+public: // methods
+
+    explicit ArchiveStream(std::unique_ptr<ArchiveStreamImpl>&& impl);
+
+    ArchiveStream(ArchiveStream&& rhs) noexcept;
+    ArchiveStream& operator=(ArchiveStream&& rhs) noexcept;
+
+    ~ArchiveStream();
+
+    /// Append data to the object
+    /// @param data A pointer to a (read-only) copy of the data, which may be reused once this returns
+    /// @param length The length of the data in bytes
+    void write(const void* data, size_t length);
+
+    /// Index the completed object. The stream cannot be written to afterwards.
+    /// @returns The length of the object in bytes
+    size_t commit();
+
+private: // members
+
+    std::unique_ptr<ArchiveStreamImpl> impl_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// The distinct values of each keyword, in sorted order
+using Axes = std::map<std::string, std::vector<std::string>>;
+
+//-------------------------------------------------------------------------------------------------
+
+}  // namespace dasi
@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include "eckit/exception/Exceptions.h"
+
 #include <iterator>
 #include <memory>
+#include <string>
 
 
 namespace dasi {
@@ -27,6 +30,14 @@ public: // methods
 
     [[ nodiscard ]]
     virtual bool done() const = 0;
+
+    /// The cursor from which a later listing resumes, after the current element. Only generators
+    /// that can be resumed provide one.
+    [[ nodiscard ]]
+    virtual std::string cursor() const {
+        throw eckit::UserError("A cursor is only available for a paged list, with a limit or cursor in its options",
+                               Here());
+    }
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -1,6 +1,8 @@
 
 #include "dasi/api/detail/ListDetail.h"
 
+#include "eckit/exception/Exceptions.h"
+
 namespace dasi {
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -20,5 +22,12 @@ void ListElement::print(std::ostream& s, bool withLocation) const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+std::string ListGenerator::cursor() const {
+    ASSERT(impl_);
+    return impl_->cursor();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 } // namespace dasi
 
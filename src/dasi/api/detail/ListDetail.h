@@ -9,6 +9,11 @@
 
 #include "eckit/filesystem/URI.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
 
 namespace dasi {
 
@@ -36,7 +41,9 @@ public: // methods
 struct ListElement {
     Key key;
     DataLocation location;
-    time_t timestamp;
+    time_t timestamp = 0;
+    /// CRC-32C of the data, if it was archived with checksums enabled
+    std::optional<uint32_t> checksum;
 
 private: // members
 
@@ -52,7 +59,46 @@ public: // methods
 
 //-------------------------------------------------------------------------------------------------
 
-using ListGenerator = GenericGenerator<ListElement>;
+/// Which details of the listed objects are filled in. The others are left default constructed.
+/// Building the locations is most of the cost of a list, so leave them out if they are not needed.
+enum class ListFields {
+    Keys,              ///< Only the keys
+    KeysAndTimestamp,  ///< The keys, and the times the objects were archived
+    Locations,         ///< Also the locations of the data as stored, without reading any of it. Objects
+                       ///< archived with compression or checksums report their stored lengths.
+    Full               ///< Everything, including the lengths and checksums of the data. Objects in spaces
+                       ///< configured with compression or checksums have the start of their data read to
+                       ///< find these. Others are reported as stored, without reading any data.
+};
+
+struct ListOptions {
+    ListFields fields = ListFields::Full;
+    /// Only list the objects archived at or after this time, for consumers polling for new data.
+    /// Archive times are only recorded to the second, so a poller passing the latest timestamp it
+    /// has seen will see the objects archived in that second again.
+    time_t since = 0;
+    /// Return at most this many objects (0 for no limit). The listing can then be continued from
+    /// ListGenerator::cursor(). A paged list is in the order of the keys, and continues after the
+    /// key of the cursor, so objects archived between pages are only listed if their keys come later.
+    size_t limit = 0;
+    /// Continue a paged listing, from a cursor returned by ListGenerator::cursor()
+    std::string cursor;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+class ListGenerator : public GenericGenerator<ListElement> {
+
+public: // methods
+
+    using GenericGenerator<ListElement>::GenericGenerator;
+
+    /// The cursor from which a later list resumes, after the current element (the last one, once
+    /// the iteration has finished). Empty if there are no more elements.
+    /// @note Only available if the list is paged, by setting ListOptions::limit or ListOptions::cursor
+    [[ nodiscard ]]
+    std::string cursor() const;
+};
 
 //-------------------------------------------------------------------------------------------------
 
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/api/detail/QueryValues.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include <cstdio>
+#include <limits>
+#include <sstream>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+bool isWord(const std::string& value, const char* lower, const char* upper) {
+    return value == lower || value == upper;
+}
+
+bool parseInteger(const std::string& s, int64_t& value) {
+    size_t i = (!s.empty() && (s[0] == '-' || s[0] == '+')) ? 1 : 0;
+    if (i == s.size() || s.size() - i > 18) return false;
+    int64_t v = 0;
+    for (; i < s.size(); ++i) {
+        if (s[i] < '0' || s[i] > '9') return false;
+        v = v * 10 + (s[i] - '0');
+    }
+    value = (s[0] == '-') ? -v : v;
+    return true;
+}
+
+// Conversions between civil dates and days since 1970-01-01 (proleptic Gregorian calendar)
+
+int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+void civilFromDays(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+/// Parse YYYYMMDD or YYYY-MM-DD, if it is a valid calendar date
+bool parseDate(const std::string& s, int64_t& days, bool& iso) {
+
+    std::string digits;
+    if (s.size() == 8) {
+        digits = s;
+        iso = false;
+    } else if (s.size() == 10 && s[4] == '-' && s[7] == '-') {
+        digits = s.substr(0, 4) + s.substr(5, 2) + s.substr(8, 2);
+        iso = true;
+    } else {
+        return false;
+    }
+
+    int64_t v;
+    if (digits[0] == '-' || digits[0] == '+' || !parseInteger(digits, v)) return false;
+
+    const int64_t y = v / 10000;
+    const unsigned m = static_cast<unsigned>((v / 100) % 100);
+    const unsigned d = static_cast<unsigned>(v % 100);
+    if (m < 1 || m > 12 || d < 1) return false;
+
+    static const unsigned monthDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    if (d > monthDays[m - 1] + ((m == 2 && leap) ? 1 : 0)) return false;
+
+    days = daysFromCivil(y, m, d);
+    return true;
+}
+
+[[ noreturn ]] void invalidRange(const std::vector<std::string>& values, const char* reason) {
+    std::ostringstream ss;
+    ss << "Invalid range in query values \"";
+    for (size_t i = 0; i < values.size(); ++i) { ss << (i ? "/" : "") << values[i]; }
+    ss << "\": " << reason;
+    throw eckit::UserError(ss.str(), Here());
+}
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+QueryValues::QueryValues(const std::vector<std::string>& values) : values_(values) {
+
+    if (values.size() == 1 && isWord(values[0], "all", "ALL")) {
+        all_ = true;
+        return;
+    }
+
+    for (size_t i = 0; i < values.size(); ++i) {
+
+        if (isWord(values[i], "to", "TO") || isWord(values[i], "by", "BY")) {
+            invalidRange(values, "'to' and 'by' must follow a value");
+        }
+
+        if (i + 1 == values.size() || !isWord(values[i + 1], "to", "TO")) {
+            segments_.push_back(Segment{Segment::Literal, i, 0, 0, 1, 0});
+            continue;
+        }
+
+        if (i + 2 == values.size()) invalidRange(values, "'to' must be followed by a value");
+
+        const std::string& first = values[i];
+        const std::string& last = values[i + 2];
+        i += 2;
+
+        int64_t step = 1;
+        if (i + 1 < values.size() && isWord(values[i + 1], "by", "BY")) {
+            if (i + 2 == values.size() || !parseInteger(values[i + 2], step)) {
+                invalidRange(values, "'by' must be followed by an integer");
+            }
+            if (step == 0) invalidRange(values, "the step must not be zero");
+            i += 2;
+        }
+
+        Segment segment{Segment::Integer, 0, 0, step, 0, 0};
+        int64_t start;
+        int64_t end;
+        bool isoStart;
+        bool isoEnd;
+
+        if (parseDate(first, start, isoStart) && parseDate(last, end, isoEnd) && isoStart == isoEnd) {
+            segment.type = isoStart ? Segment::ISODate : Segment::Date;
+        } else if (parseInteger(first, start) && parseInteger(last, end)) {
+            if (first.size() > 1 && first[0] == '0') { segment.width = first.size(); }
+        } else {
+            invalidRange(values, "the endpoints must both be integers, or both be dates");
+        }
+
+        if (end != start && (end > start) != (step > 0)) {
+            invalidRange(values, "the step goes away from the end of the range");
+        }
+
+        segment.start = start;
+        segment.count = static_cast<size_t>((end - start) / step) + 1;
+        segments_.push_back(segment);
+        hasRanges_ = true;
+    }
+
+    for (const auto& segment : segments_) { size_ += segment.count; }
+}
+
+void QueryValues::format(const Segment& segment, size_t position, std::string& out) {
+
+    const int64_t value = segment.start + static_cast<int64_t>(position) * segment.step;
+    char buf[32];
+
+    if (segment.type == Segment::Integer) {
+        std::snprintf(buf, sizeof(buf), "%0*lld", int(value < 0 ? 0 : segment.width), static_cast<long long>(value));
+    } else {
+        int64_t y;
+        unsigned m;
+        unsigned d;
+        civilFromDays(value, y, m, d);
+        std::snprintf(buf, sizeof(buf), segment.type == Segment::ISODate ? "%04lld-%02u-%02u" : "%04lld%02u%02u",
+                      static_cast<long long>(y), m, d);
+    }
+
+    out.assign(buf);
+}
+
+//-------------------------------------------------------------------------------------------------
+
+QueryValues::const_iterator::const_iterator(const QueryValues& values, size_t segment) :
+    values_(&values), segment_(segment) {}
+
+QueryValues::const_iterator::reference QueryValues::const_iterator::operator*() const {
+    const auto& segment = values_->segments_[segment_];
+    if (segment.type == Segment::Literal) return values_->values_[segment.literal];
+    if (!formatted_) {
+        format(segment, position_, current_);
+        formatted_ = true;
+    }
+    return current_;
+}
+
+QueryValues::const_iterator& QueryValues::const_iterator::operator++() {
+    if (++position_ == values_->segments_[segment_].count) {
+        ++segment_;
+        position_ = 0;
+    }
+    formatted_ = false;
+    return *this;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
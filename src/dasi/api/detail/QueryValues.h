@@ -0,0 +1,132 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// The values of a query keyword, with MARS-style ranges expanded lazily:
+///
+///     step=0/to/240/by/6      # 0, 6, 12, ..., 240
+///     level=1/to/137          # 1, 2, ..., 137
+///     date=20230101/to/20230131/by/7
+///     date=2023-01-01/to/2023-01-31
+///     number=all              # any value
+///
+/// Ranges may be mixed with literal values (`0/1/to/5/10`). Integer ranges keep the width of a
+/// zero-padded start value (`001/to/010`). Endpoints that are both valid calendar dates, as
+/// YYYYMMDD or YYYY-MM-DD, give date ranges stepping in days. A negative step gives a descending
+/// range.
+///
+/// Nothing is materialised: the ranges are described by their endpoints and step, and each value
+/// is formatted as it is reached. The values referred to must outlive this object.
+
+class QueryValues {
+
+    struct Segment {
+        enum Type { Literal, Integer, Date, ISODate } type;
+        size_t literal;   // Index of the literal value
+        int64_t start;    // Integer value, or days since 1970-01-01
+        int64_t step;
+        size_t count;
+        size_t width;     // Zero-padding of integers
+    };
+
+public: // types
+
+    class const_iterator {
+
+    public: // types
+
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string*;
+        using reference = const std::string&;
+
+    public: // methods
+
+        const_iterator(const QueryValues& values, size_t segment);
+
+        reference operator*() const;
+        pointer operator->() const { return &**this; }
+
+        const_iterator& operator++();
+
+        bool operator==(const const_iterator& rhs) const {
+            return segment_ == rhs.segment_ && position_ == rhs.position_;
+        }
+        bool operator!=(const const_iterator& rhs) const { return !(*this == rhs); }
+
+    private: // members
+
+        const QueryValues* values_;
+        size_t segment_;
+        size_t position_ = 0;
+
+        // The formatted value, for ranges
+        mutable std::string current_;
+        mutable bool formatted_ = false;
+    };
+
+public: // methods
+
+    /// @throws eckit::UserError if a range is malformed
+    explicit QueryValues(const std::vector<std::string>& values);
+
+    /// Were any values given as ranges?
+    [[ nodiscard ]]
+    bool hasRanges() const { return hasRanges_; }
+
+    /// Was `all` given? There are then no values to iterate over.
+    [[ nodiscard ]]
+    bool all() const { return all_; }
+
+    /// The number of values, once expanded
+    [[ nodiscard ]]
+    size_t size() const { return size_; }
+
+    [[ nodiscard ]]
+    const_iterator begin() const { return {*this, 0}; }
+    [[ nodiscard ]]
+    const_iterator end() const { return {*this, segments_.size()}; }
+
+private: // methods
+
+    static void format(const Segment& segment, size_t position, std::string& out);
+
+private: // members
+
+    const std::vector<std::string>& values_;
+    std::vector<Segment> segments_;
+    size_t size_ = 0;
+    bool hasRanges_ = false;
+    bool all_ = false;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
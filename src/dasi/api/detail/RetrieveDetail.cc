@@ -17,6 +17,14 @@ size_t RetrieveResult::count() const {
     return impl().count();
 }
 
+size_t RetrieveResult::dataLength() const {
+    return impl().decoded().length;
+}
+
+std::optional<uint32_t> RetrieveResult::checksum() const {
+    return impl().decoded().checksum;
+}
+
 const RetrieveResultImpl& RetrieveResult::impl() const {
     const auto* ret = static_cast<const RetrieveResultImpl*>(impl_.get());
     ASSERT(ret);
@@ -7,7 +7,9 @@
 #include "eckit/io/DataHandle.h"
 #include "dasi/api/detail/ListDetail.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 
 namespace dasi {
 
@@ -19,6 +21,10 @@ using RetrieveElement = ListElement;
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// The elements give the locations of the objects as stored, without reading any of them. The data
+/// returned by dataHandle() is decoded, if it was stored compressed or checksummed, and its length
+/// and checksum are given by dataLength() and checksum() for the current element.
+
 class RetrieveResult : public GenericGenerator<RetrieveElement> {
 
 public: // methods
@@ -31,6 +37,16 @@ public: // methods
     [[ nodiscard ]]
     size_t count() const;
 
+    /// The length of the data of the current element, as read from dataHandle(). Reads the start of
+    /// the object if it is in a space configured with compression or checksums.
+    [[ nodiscard ]]
+    size_t dataLength() const;
+
+    /// The CRC-32C of the data of the current element, if it was archived with one. Reads the start
+    /// of the object if it is in a space configured with compression or checksums.
+    [[ nodiscard ]]
+    std::optional<uint32_t> checksum() const;
+
 private: // members
 
     friend std::ostream& operator<<(std::ostream& s, const RetrieveResult& rr) {
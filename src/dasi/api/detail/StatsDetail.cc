@@ -0,0 +1,117 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/api/detail/StatsDetail.h"
+
+#include "eckit/log/JSON.h"
+
+#include <cmath>
+#include <utility>
+#include <ostream>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+void writeJSON(eckit::JSON& json, const OperationStats& value) {
+    json.startObject();
+    json << "calls" << value.calls;
+    json << "bytes" << value.bytes;
+    json << "seconds" << value.seconds;
+    json << "latency_us";
+    json.startList();
+    for (size_t count : value.latency) { json << count; }
+    json.endList();
+    json.endObject();
+}
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+double OperationStats::bucketLimit(size_t bucket) {
+    return std::ldexp(1.0, int(bucket)) * 1e-6;
+}
+
+double OperationStats::percentile(double p) const {
+    if (calls == 0) return 0;
+    const double target = calls * p / 100.0;
+    size_t seen = 0;
+    for (size_t i = 0; i < latency.size(); ++i) {
+        seen += latency[i];
+        if (seen >= target) return bucketLimit(i);
+    }
+    return bucketLimit(latency.size() - 1);
+}
+
+void OperationStats::json(std::ostream& s) const {
+    eckit::JSON json(s);
+    writeJSON(json, *this);
+}
+
+void Stats::json(std::ostream& s) const {
+    eckit::JSON json(s);
+    json.startObject();
+    for (const auto& op : {std::make_pair("archive", &archive), std::make_pair("flush", &flush),
+                           std::make_pair("list", &list), std::make_pair("retrieve", &retrieve),
+                           std::make_pair("wipe", &wipe), std::make_pair("purge", &purge),
+                           std::make_pair("read", &read)}) {
+        json << op.first;
+        writeJSON(json, *op.second);
+    }
+    json << "flush_triggers";
+    json.startObject();
+    json << "explicit" << flushTriggers.explicitFlushes;
+    json << "max_bytes" << flushTriggers.maxBytes;
+    json << "max_objects" << flushTriggers.maxObjects;
+    json << "max_interval_ms" << flushTriggers.maxInterval;
+    json.endObject();
+    json << "cache";
+    json.startObject();
+    json << "hits" << cache.hits;
+    json << "misses" << cache.misses;
+    json << "stale" << cache.stale;
+    json << "evictions" << cache.evictions;
+    json.endObject();
+    json.endObject();
+}
+
+void Stats::print(std::ostream& s) const {
+    auto line = [&s](const char* name, const OperationStats& op) {
+        s << name << ": calls=" << op.calls << ", bytes=" << op.bytes << ", seconds=" << op.seconds
+          << ", p50<=" << op.percentile(50) << "s, p99<=" << op.percentile(99) << "s" << std::endl;
+    };
+    line("archive", archive);
+    line("flush", flush);
+    line("list", list);
+    line("retrieve", retrieve);
+    line("wipe", wipe);
+    line("purge", purge);
+    line("read", read);
+    s << "flush triggers: explicit=" << flushTriggers.explicitFlushes << ", max_bytes=" << flushTriggers.maxBytes
+      << ", max_objects=" << flushTriggers.maxObjects << ", max_interval_ms=" << flushTriggers.maxInterval
+      << std::endl;
+    s << "cache: hits=" << cache.hits << ", misses=" << cache.misses << ", stale=" << cache.stale
+      << ", evictions=" << cache.evictions << std::endl;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iosfwd>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Statistics for one type of operation
+struct OperationStats {
+
+    static constexpr size_t latencyBuckets = 32;
+
+    /// The number of calls
+    size_t calls = 0;
+
+    /// The number of bytes archived, retrieved or read
+    size_t bytes = 0;
+
+    /// The total time spent in the calls
+    double seconds = 0;
+
+    /// Latency histogram. Bucket 0 counts calls taking less than 1us, and bucket i calls taking
+    /// between 2^(i-1) and 2^i us. The last bucket also counts anything slower.
+    std::array<size_t, latencyBuckets> latency{};
+
+    /// The upper latency limit of a bucket, in seconds
+    static double bucketLimit(size_t bucket);
+
+    /// An upper bound on the given latency percentile (0-100), in seconds
+    double percentile(double p) const;
+
+    void json(std::ostream& s) const;
+};
+
+/// How many flushes each trigger of the automatic flush policy has caused
+struct FlushTriggerStats {
+    size_t explicitFlushes = 0;
+    size_t maxBytes = 0;
+    size_t maxObjects = 0;
+    size_t maxInterval = 0;
+};
+
+/// How the catalogue cache has been used, if it is enabled
+struct CacheStats {
+    size_t hits = 0;
+    /// Lookups not found in the cache, including the stale ones
+    size_t misses = 0;
+    /// Entries found to be out of date, by age or by changes to their TOCs
+    size_t stale = 0;
+    /// Entries dropped to keep within the budget
+    size_t evictions = 0;
+};
+
+/// A snapshot of the operation statistics of a Dasi session
+struct Stats {
+    OperationStats archive;
+    OperationStats flush;
+    OperationStats list;
+    OperationStats retrieve;
+    OperationStats wipe;
+    OperationStats purge;
+
+    /// Reads from the data handles of retrieve results
+    OperationStats read;
+
+    FlushTriggerStats flushTriggers;
+
+    CacheStats cache;
+
+    void json(std::ostream& s) const;
+
+private: // methods
+
+    friend std::ostream& operator<<(std::ostream& s, const Stats& stats) {
+        stats.print(s);
+        return s;
+    };
+
+    void print(std::ostream& s) const;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
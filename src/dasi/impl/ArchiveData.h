@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "eckit/io/Buffer.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Data to be archived, that is owned by DASI until it has been written.
+///
+/// Either a buffer (which may be recycled by the owner once written), or external memory with
+/// a release function that is called exactly once when the data is no longer needed.
+
+class ArchiveData {
+
+public: // methods
+
+    ArchiveData() = default;
+
+    ArchiveData(std::unique_ptr<eckit::Buffer>&& buffer, size_t length) :
+        data_(buffer->data()), length_(length), buffer_(std::move(buffer)) {}
+
+    ArchiveData(const void* data, size_t length, std::function<void()>&& release) :
+        data_(data), length_(length), release_(std::move(release)) {}
+
+    ArchiveData(ArchiveData&& rhs) noexcept :
+        data_(rhs.data_), length_(rhs.length_), buffer_(std::move(rhs.buffer_)), release_(std::move(rhs.release_)) {
+        rhs.release_ = nullptr;
+    }
+
+    ArchiveData& operator=(ArchiveData&& rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            data_ = rhs.data_;
+            length_ = rhs.length_;
+            buffer_ = std::move(rhs.buffer_);
+            release_ = std::move(rhs.release_);
+            rhs.release_ = nullptr;
+        }
+        return *this;
+    }
+
+    ArchiveData(const ArchiveData&) = delete;
+    ArchiveData& operator=(const ArchiveData&) = delete;
+
+    ~ArchiveData() { reset(); }
+
+    [[ nodiscard ]]
+    const void* data() const { return data_; }
+
+    [[ nodiscard ]]
+    size_t length() const { return length_; }
+
+    /// Hand the underlying buffer (if any) back for reuse. The data is no longer accessible.
+    std::unique_ptr<eckit::Buffer> takeBuffer() {
+        data_ = nullptr;
+        return std::move(buffer_);
+    }
+
+private: // methods
+
+    void reset() {
+        buffer_.reset();
+        if (release_) {
+            auto release = std::move(release_);
+            release_ = nullptr;
+            release();
+        }
+    }
+
+private: // members
+
+    const void* data_ = nullptr;
+    size_t length_ = 0;
+
+    std::unique_ptr<eckit::Buffer> buffer_;
+    std::function<void()> release_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
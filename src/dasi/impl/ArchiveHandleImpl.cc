@@ -0,0 +1,63 @@
+
+#include "dasi/impl/ArchiveHandleImpl.h"
+
+#include "fdb5/rules/Schema.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include <sstream>
+
+namespace dasi {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ArchiveHandleImpl::ArchiveHandleImpl(const Key& prefix, const fdb5::Schema& schema, Sink&& sink) :
+    prefix_(prefix),
+    sink_(std::move(sink)) {
+
+    for (const auto& kv : prefix_) { prefixKey_.set(kv.first, kv.second); }
+
+    // Resolve the database up front, so that an unusable prefix is reported by prepare()
+
+    fdb5::Key dbKey;
+    if (!schema.expandFirstLevel(prefixKey_, dbKey)) {
+        std::ostringstream ss;
+        ss << "Prefix " << prefix_ << " does not specify the first level of the schema";
+        throw eckit::UserError(ss.str(), Here());
+    }
+
+    current_ = prefixKey_;
+}
+
+void ArchiveHandleImpl::archive(const Key& leaf, const void* data, size_t length) {
+
+    if (!sameLeafKeywords(leaf)) {
+        current_ = prefixKey_;
+        leafKeywords_.clear();
+        for (const auto& kv : leaf) {
+            if (prefix_.has(kv.first)) {
+                std::ostringstream ss;
+                ss << "Keyword " << kv.first << " is already specified by the prefix " << prefix_;
+                throw eckit::UserError(ss.str(), Here());
+            }
+            leafKeywords_.push_back(kv.first);
+        }
+    }
+
+    for (const auto& kv : leaf) { current_.set(kv.first, kv.second); }
+
+    sink_(current_, data, length);
+}
+
+bool ArchiveHandleImpl::sameLeafKeywords(const Key& leaf) const {
+    if (leaf.size() != leafKeywords_.size()) return false;
+    auto it = leafKeywords_.begin();
+    for (const auto& kv : leaf) {
+        if (kv.first != *it++) return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi
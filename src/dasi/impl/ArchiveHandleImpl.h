@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/api/detail/ArchiveDetail.h"
+
+#include "fdb5/database/Key.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace fdb5 { class Schema; }
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+class ArchiveHandleImpl {
+
+public: // types
+
+    /// Where fully assembled keys and their data are sent to be archived
+    using Sink = std::function<void(const fdb5::Key&, const void*, size_t)>;
+
+public: // methods
+
+    ArchiveHandleImpl(const Key& prefix, const fdb5::Schema& schema, Sink&& sink);
+
+    void archive(const Key& leaf, const void* data, size_t length);
+
+    [[ nodiscard ]]
+    const Key& prefix() const { return prefix_; }
+
+private: // methods
+
+    bool sameLeafKeywords(const Key& leaf) const;
+
+private: // members
+
+    Key prefix_;
+
+    /// The converted prefix
+    fdb5::Key prefixKey_;
+
+    /// The prefix, plus the leaf keywords of the previous archive. Updated in place while the
+    /// leaf keywords do not change.
+    fdb5::Key current_;
+    std::vector<std::string> leafKeywords_;
+
+    Sink sink_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
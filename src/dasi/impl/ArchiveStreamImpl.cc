@@ -0,0 +1,122 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/ArchiveStreamImpl.h"
+
+#include "dasi/impl/DirectStore.h"
+#include "dasi/impl/ObjectEncoding.h"
+
+#include "fdb5/config/Config.h"
+#include "fdb5/database/FieldLocation.h"
+#include "fdb5/database/Store.h"
+#include "fdb5/rules/Schema.h"
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+
+#include <sstream>
+
+namespace dasi {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ArchiveStreamImpl::ArchiveStreamImpl(const Key& key, const fdb5::Config& config, const ObjectEncoder& encoder,
+                                     Indexer&& indexer, Sink&& sink) :
+    indexer_(std::move(indexer)),
+    sink_(std::move(sink)) {
+
+    for (const auto& kv : key) { key_.set(kv.first, kv.second); }
+
+    // Resolve the database up front, so that an unusable key is reported before any data is written
+
+    if (!config.schema().expandFirstLevel(key_, dbKey_)) {
+        std::ostringstream ss;
+        ss << "Key " << key << " does not match the first level of the schema";
+        throw eckit::UserError(ss.str(), Here());
+    }
+
+    encoding_ = encoder.encodeStream(key_);
+    if (!encoding_) { store_ = openStore(config, dbKey_); }
+}
+
+ArchiveStreamImpl::~ArchiveStreamImpl() {
+    // Data written to a stream that is not committed is left unindexed in the store
+    if (store_) {
+        try {
+            store_->close();
+        } catch (const std::exception& e) {
+            eckit::Log::error() << "Failed to close the store of an archive stream: " << e.what() << std::endl;
+        }
+    }
+}
+
+void ArchiveStreamImpl::write(const void* data, size_t length) {
+
+    if (committed_) { throw eckit::UserError("Cannot write to an archive stream once it is committed", Here()); }
+    if (length == 0) return;
+
+    if (encoding_) {
+        encoding_->write(data, length);
+        length_ += length;
+        return;
+    }
+
+    // The store appends everything archived to it for one key to the same data file, so the pieces
+    // are contiguous and are indexed as one object
+
+    std::unique_ptr<fdb5::FieldLocation> location(store_->archive(dbKey_, data, length));
+    if (!start_) {
+        start_ = std::move(location);
+    } else if (location->uri().asString() != start_->uri().asString() ||
+               static_cast<long long>(location->offset()) !=
+                       static_cast<long long>(start_->offset()) + static_cast<long long>(length_)) {
+        std::ostringstream ss;
+        ss << "Streamed data for " << key_ << " is not stored contiguously: expected " << start_->uri() << " at "
+           << (static_cast<long long>(start_->offset()) + static_cast<long long>(length_)) << ", got "
+           << location->uri() << " at " << location->offset();
+        throw eckit::SeriousBug(ss.str(), Here());
+    }
+    length_ += length;
+}
+
+size_t ArchiveStreamImpl::commit() {
+
+    if (committed_) { throw eckit::UserError("Archive stream is already committed", Here()); }
+    committed_ = true;
+
+    if (encoding_) {
+        size_t encodedLength;
+        auto encoded = encoding_->finish(encodedLength);
+        encoding_.reset();
+        sink_(key_, ArchiveData(std::move(encoded), encodedLength), length_);
+    } else if (start_) {
+        store_->flush();
+        store_->close();
+        store_.reset();
+        indexer_(key_, *partOf(*start_, 0, length_), length_);
+    } else {
+        // Nothing was written, so there is no location to index
+        sink_(key_, ArchiveData(), 0);
+    }
+
+    return length_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/api/detail/ArchiveDetail.h"
+#include "dasi/impl/ArchiveData.h"
+
+#include "fdb5/database/Key.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace fdb5 { class Config; class FieldLocation; class Store; }
+
+namespace dasi {
+
+class EncodeStream;
+class ObjectEncoder;
+
+//-------------------------------------------------------------------------------------------------
+
+/// Writes an object to the object store as it is streamed in, so that it is never held in memory
+/// in full.
+///
+/// Objects stored as they are are appended to the data of their database piece by piece, and
+/// indexed once complete, so an object is not visible until it is committed. Data written to a
+/// stream that is never committed is not indexed. Objects in spaces with compression or checksums
+/// are encoded chunk by chunk (see EncodeStream), and archived as usual once complete.
+
+class ArchiveStreamImpl {
+
+public: // types
+
+    /// Indexes a complete object, already written to the store at the given location
+    using Indexer = std::function<void(const fdb5::Key&, const fdb5::FieldLocation&, size_t)>;
+
+    /// Where complete objects held in memory are sent to be archived, with their logical length
+    using Sink = std::function<void(const fdb5::Key&, ArchiveData&&, size_t)>;
+
+public: // methods
+
+    ArchiveStreamImpl(const Key& key, const fdb5::Config& config, const ObjectEncoder& encoder, Indexer&& indexer,
+                      Sink&& sink);
+    ~ArchiveStreamImpl();
+
+    void write(const void* data, size_t length);
+
+    /// @returns The length of the object in bytes
+    size_t commit();
+
+private: // members
+
+    fdb5::Key key_;
+    fdb5::Key dbKey_;
+
+    std::unique_ptr<EncodeStream> encoding_;  // Only in spaces with compression or checksums
+    std::unique_ptr<fdb5::Store> store_;      // Otherwise
+
+    // Where the object starts in the store, once any of it is written
+    std::unique_ptr<fdb5::FieldLocation> start_;
+    size_t length_ = 0;
+    bool committed_ = false;
+
+    Indexer indexer_;
+    Sink sink_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
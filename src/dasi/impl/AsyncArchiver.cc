@@ -0,0 +1,338 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dasi/impl/AsyncArchiver.h"
+
+#include "dasi/lib/LibDasi.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/rules/Schema.h"
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/log/Log.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// A queue of data to archive, drained by one thread into its own FDB instance
+
+class ArchiveWriter {
+
+public: // methods
+
+    ArchiveWriter(const fdb5::Config& config, size_t maxBytes);
+    ~ArchiveWriter();
+
+    void archive(const fdb5::Key& key, const void* data, size_t length);
+    void archive(const fdb5::Key& key, ArchiveData&& data);
+
+    /// Queues a flush behind all of the data queued so far
+    /// @returns A ticket to wait on
+    size_t requestFlush();
+
+    /// Waits for a requested flush to complete
+    /// @returns Any error raised by the writer since it was last reported
+    std::exception_ptr waitFlush(size_t ticket);
+
+private: // types
+
+    struct Item {
+        fdb5::Key key;
+        ArchiveData data;
+        bool flush = false;
+    };
+
+private: // methods
+
+    void run();
+
+    /// Blocks until there is space for length bytes in flight, and reserves it
+    void reserve(std::unique_lock<std::mutex>& lock, size_t length);
+
+    void enqueue(const fdb5::Key& key, ArchiveData&& data);
+
+    void rethrowError();
+
+    std::unique_ptr<eckit::Buffer> acquireBuffer(size_t length);
+    void releaseBuffer(std::unique_ptr<eckit::Buffer>&& buffer);
+
+private: // members
+
+    fdb5::FDB fdb_;
+
+    const size_t maxBytes_;
+
+    std::mutex mutex_;
+    std::condition_variable cvWork_;
+    std::condition_variable cvDone_;
+
+    std::deque<Item> queue_;
+    size_t inFlightBytes_ = 0;
+
+    size_t flushesRequested_ = 0;
+    size_t flushesCompleted_ = 0;
+
+    std::exception_ptr error_;
+    bool stop_ = false;
+
+    std::vector<std::unique_ptr<eckit::Buffer>> pool_;
+    size_t pooledBytes_ = 0;
+
+    std::thread thread_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+ArchiveWriter::ArchiveWriter(const fdb5::Config& config, size_t maxBytes) :
+    fdb_(config),
+    maxBytes_(maxBytes) {
+    ASSERT(maxBytes_ > 0);
+    thread_ = std::thread(&ArchiveWriter::run, this);
+}
+
+ArchiveWriter::~ArchiveWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cvWork_.notify_all();
+    thread_.join();
+
+    if (error_) {
+        try {
+            std::rethrow_exception(error_);
+        } catch (const std::exception& e) {
+            eckit::Log::error() << "Unreported error in asynchronous archive: " << e.what() << std::endl;
+        } catch (...) {
+            eckit::Log::error() << "Unreported error in asynchronous archive" << std::endl;
+        }
+    }
+}
+
+void ArchiveWriter::archive(const fdb5::Key& key, const void* data, size_t length) {
+
+    std::unique_ptr<eckit::Buffer> buffer;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        reserve(lock, length);
+        buffer = acquireBuffer(length);
+    }
+
+    ::memcpy(buffer->data(), data, length);
+
+    enqueue(key, ArchiveData(std::move(buffer), length));
+}
+
+void ArchiveWriter::archive(const fdb5::Key& key, ArchiveData&& data) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        reserve(lock, data.length());
+    }
+    enqueue(key, std::move(data));
+}
+
+void ArchiveWriter::reserve(std::unique_lock<std::mutex>& lock, size_t length) {
+
+    // Backpressure. A single object larger than the limit is still accepted, once the queue is empty.
+    cvDone_.wait(lock, [this, length] {
+        return error_ || inFlightBytes_ == 0 || inFlightBytes_ + length <= maxBytes_;
+    });
+    rethrowError();
+
+    inFlightBytes_ += length;
+}
+
+void ArchiveWriter::enqueue(const fdb5::Key& key, ArchiveData&& data) {
+
+    Item item;
+    item.key = key;
+    item.data = std::move(data);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(item));
+    }
+    cvWork_.notify_one();
+}
+
+size_t ArchiveWriter::requestFlush() {
+
+    Item item;
+    item.flush = true;
+
+    size_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(item));
+        ticket = ++flushesRequested_;
+    }
+    cvWork_.notify_one();
+    return ticket;
+}
+
+std::exception_ptr ArchiveWriter::waitFlush(size_t ticket) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cvDone_.wait(lock, [this, ticket] { return flushesCompleted_ >= ticket; });
+
+    std::exception_ptr error;
+    std::swap(error, error_);
+    return error;
+}
+
+void ArchiveWriter::run() {
+
+    for (;;) {
+
+        Item item;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cvWork_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) { return; }
+            item = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        std::exception_ptr error;
+        try {
+            if (item.flush) {
+                fdb_.flush();
+            } else {
+                fdb_.archive(item.key, item.data.data(), item.data.length());
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error && !error_) { error_ = error; }
+            if (item.flush) {
+                ++flushesCompleted_;
+            } else {
+                inFlightBytes_ -= item.data.length();
+                if (auto buffer = item.data.takeBuffer()) { releaseBuffer(std::move(buffer)); }
+            }
+        }
+        cvDone_.notify_all();
+
+        // n.b. externally owned data is released here, outside of the lock
+    }
+}
+
+void ArchiveWriter::rethrowError() {
+    if (error_) {
+        std::exception_ptr error;
+        std::swap(error, error_);
+        std::rethrow_exception(error);
+    }
+}
+
+std::unique_ptr<eckit::Buffer> ArchiveWriter::acquireBuffer(size_t length) {
+
+    // Best fit from the pool of staging buffers, otherwise allocate a new one
+
+    auto best = pool_.end();
+    for (auto it = pool_.begin(); it != pool_.end(); ++it) {
+        if ((*it)->size() >= length && (best == pool_.end() || (*it)->size() < (*best)->size())) { best = it; }
+    }
+
+    if (best == pool_.end()) { return std::make_unique<eckit::Buffer>(length); }
+
+    std::unique_ptr<eckit::Buffer> buffer = std::move(*best);
+    pool_.erase(best);
+    pooledBytes_ -= buffer->size();
+    return buffer;
+}
+
+void ArchiveWriter::releaseBuffer(std::unique_ptr<eckit::Buffer>&& buffer) {
+    if (pooledBytes_ + buffer->size() <= maxBytes_) {
+        pooledBytes_ += buffer->size();
+        pool_.push_back(std::move(buffer));
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+
+AsyncArchiver::AsyncArchiver(const fdb5::Config& config, size_t maxBytes, size_t writers) :
+    config_(config), databases_(config_.schema()) {
+
+    ASSERT(writers > 0);
+    LOG_DEBUG_LIB(LibDasi) << "Asynchronous archive enabled, writers=" << writers << ", limit=" << maxBytes
+                           << " bytes" << std::endl;
+
+    // The in-flight limit is shared evenly between the writers
+    for (size_t i = 0; i < writers; ++i) {
+        writers_.emplace_back(std::make_unique<ArchiveWriter>(config_, std::max<size_t>(maxBytes / writers, 1)));
+    }
+}
+
+AsyncArchiver::~AsyncArchiver() = default;
+
+void AsyncArchiver::archive(const fdb5::Key& key, const void* data, size_t length) {
+    route(key).archive(key, data, length);
+}
+
+void AsyncArchiver::archive(const fdb5::Key& key, ArchiveData&& data) {
+    route(key).archive(key, std::move(data));
+}
+
+void AsyncArchiver::flush() {
+
+    // Queue the flushes everywhere before waiting on any of them, so that they proceed in parallel
+
+    std::vector<size_t> tickets;
+    tickets.reserve(writers_.size());
+    for (auto& writer : writers_) { tickets.push_back(writer->requestFlush()); }
+
+    std::exception_ptr error;
+    for (size_t i = 0; i < writers_.size(); ++i) {
+        auto e = writers_[i]->waitFlush(tickets[i]);
+        if (e && !error) { error = e; }
+    }
+
+    if (error) { std::rethrow_exception(error); }
+}
+
+ArchiveWriter& AsyncArchiver::route(const fdb5::Key& key) {
+
+    if (writers_.size() == 1) { return *writers_[0]; }
+
+    // Databases are assigned to the writers in turn, as they are first seen
+
+    const fdb5::Key dbKey = databases_.database(key);
+
+    auto it = routes_.find(dbKey.valuesToString());
+    if (it == routes_.end()) {
+        const size_t next = routes_.size() % writers_.size();
+        it = routes_.emplace(dbKey.valuesToString(), next).first;
+    }
+
+    return *writers_[it->second];
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/impl/ArchiveData.h"
+#include "dasi/impl/DatabaseKeys.h"
+
+#include "fdb5/config/Config.h"
+#include "fdb5/database/Key.h"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dasi {
+
+class ArchiveWriter;
+
+//-------------------------------------------------------------------------------------------------
+
+/// Decouples archive() from the latency of the backend. Data is copied into a pooled staging
+/// buffer and queued, and background writer threads drain the queues into their own FDB instances.
+///
+/// With more than one writer, archives are routed by database (the first-level key of the schema),
+/// such that each database is always written by the same writer and ordering within a database is
+/// preserved. flush() fans out to all of the writers in parallel.
+///
+/// The number of bytes in flight is bounded. Once the bound is reached archive() blocks until
+/// the writer has caught up (backpressure). Errors raised by a writer are rethrown by the next
+/// call to archive() or flush().
+
+class AsyncArchiver {
+
+public: // methods
+
+    AsyncArchiver(const fdb5::Config& config, size_t maxBytes, size_t writers=1);
+
+    /// Drains the queues before the writers are stopped
+    ~AsyncArchiver();
+
+    /// Copies the data into a staging buffer
+    void archive(const fdb5::Key& key, const void* data, size_t length);
+
+    /// Queues the data without copying. It is released once written.
+    void archive(const fdb5::Key& key, ArchiveData&& data);
+
+    /// Waits for all queued data to be written, and then flushes the backend
+    void flush();
+
+private: // methods
+
+    ArchiveWriter& route(const fdb5::Key& key);
+
+private: // members
+
+    fdb5::Config config_;
+    const DatabaseKeys databases_;
+
+    std::vector<std::unique_ptr<ArchiveWriter>> writers_;
+
+    /// Database (first-level key) to writer assignments
+    std::map<std::string, size_t> routes_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/AutoFlush.h"
+
+#include "dasi/lib/LibDasi.h"
+
+#include "eckit/config/Configuration.h"
+#include "eckit/log/Log.h"
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+AutoFlush::AutoFlush(const eckit::Configuration& config, FlushFn&& flush) :
+    maxBytes_(config.getUnsigned("max_bytes", 0)),
+    maxObjects_(config.getUnsigned("max_objects", 0)),
+    maxInterval_(config.getUnsigned("max_interval_ms", 0)),
+    flush_(std::move(flush)) {
+
+    if (maxInterval_.count() > 0) {
+        thread_ = std::thread([this] { timer(); });
+    }
+}
+
+AutoFlush::~AutoFlush() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    LOG_DEBUG_LIB(LibDasi) << "Flushes: explicit=" << counters_.explicitFlushes << ", max_bytes=" << counters_.bytes
+                           << ", max_objects=" << counters_.objects << ", max_interval_ms=" << counters_.interval
+                           << std::endl;
+}
+
+AutoFlush::Trigger AutoFlush::archived(size_t length) {
+
+    bool startTimer = false;
+    Trigger trigger = Trigger::None;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (objects_ == 0) {
+            firstUnflushed_ = clock::now();
+            startTimer = true;
+        }
+        bytes_ += length;
+        ++objects_;
+
+        if (maxBytes_ > 0 && bytes_ >= maxBytes_) {
+            trigger = Trigger::Bytes;
+        } else if (maxObjects_ > 0 && objects_ >= maxObjects_) {
+            trigger = Trigger::Objects;
+        }
+    }
+
+    if (startTimer && thread_.joinable()) { cv_.notify_one(); }
+    return trigger;
+}
+
+void AutoFlush::flushed(Trigger trigger) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bytes_ = 0;
+    objects_ = 0;
+    switch (trigger) {
+        case Trigger::Explicit: ++counters_.explicitFlushes; break;
+        case Trigger::Bytes:    ++counters_.bytes; break;
+        case Trigger::Objects:  ++counters_.objects; break;
+        case Trigger::Interval: ++counters_.interval; break;
+        case Trigger::None:     break;
+    }
+}
+
+void AutoFlush::rethrowError() {
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(error, error_);
+    }
+    if (error) {
+        cv_.notify_one();
+        std::rethrow_exception(error);
+    }
+}
+
+AutoFlush::Counters AutoFlush::counters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counters_;
+}
+
+void AutoFlush::timer() {
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!stop_) {
+
+        if (objects_ == 0 || error_) {
+            cv_.wait(lock);
+            continue;
+        }
+
+        const auto deadline = firstUnflushed_ + maxInterval_;
+        if (clock::now() < deadline) {
+            cv_.wait_until(lock, deadline);
+            continue;
+        }
+
+        // The flush takes the archive lock, and then calls flushed(), so must not be called with
+        // our lock held
+
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            flush_(Trigger::Interval);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        if (error) {
+            eckit::Log::error() << "Timed flush failed, will be reported on the next archive or flush" << std::endl;
+            error_ = error;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
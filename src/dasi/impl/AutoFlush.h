@@ -0,0 +1,115 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace eckit { class Configuration; }
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Flushes automatically, so that durability does not depend on the caller remembering to. It is
+/// configured in the application configuration:
+///
+///     flush:
+///       max_bytes: 1073741824     # flush once this much data has been archived
+///       max_objects: 10000        # ... or this many objects
+///       max_interval_ms: 5000     # ... or this long after the first unflushed object
+///
+/// The size limits are checked as objects are archived, and the flush happens on the archiving
+/// thread. The time limit is enforced by a timer thread, which only wakes up while there is
+/// unflushed data. Errors raised by a timed flush are rethrown by the next archive or flush.
+
+class AutoFlush {
+
+public: // types
+
+    enum class Trigger { None = 0, Explicit, Bytes, Objects, Interval };
+
+    /// How many flushes each trigger has caused
+    struct Counters {
+        size_t explicitFlushes = 0;
+        size_t bytes = 0;
+        size_t objects = 0;
+        size_t interval = 0;
+    };
+
+    using FlushFn = std::function<void(Trigger)>;
+
+public: // methods
+
+    /// @param flush Performs a flush. Must call flushed() once it has succeeded.
+    AutoFlush(const eckit::Configuration& config, FlushFn&& flush);
+    ~AutoFlush();
+
+    AutoFlush(const AutoFlush&) = delete;
+    AutoFlush& operator=(const AutoFlush&) = delete;
+
+    /// Account for an archived object. Returns the trigger for a flush that is now due, if any.
+    [[ nodiscard ]]
+    Trigger archived(size_t length);
+
+    /// Reset the accounting, once any flush has completed
+    void flushed(Trigger trigger);
+
+    /// Rethrow any error from a timed flush
+    void rethrowError();
+
+    [[ nodiscard ]]
+    Counters counters() const;
+
+private: // methods
+
+    void timer();
+
+private: // members
+
+    using clock = std::chrono::steady_clock;
+
+    const size_t maxBytes_;
+    const size_t maxObjects_;
+    const std::chrono::milliseconds maxInterval_;
+
+    FlushFn flush_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    size_t bytes_ = 0;
+    size_t objects_ = 0;
+    clock::time_point firstUnflushed_;
+
+    Counters counters_;
+    std::exception_ptr error_;
+
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
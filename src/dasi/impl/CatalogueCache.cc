@@ -0,0 +1,168 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/CatalogueCache.h"
+
+#include "dasi/lib/LibDasi.h"
+
+#include "fdb5/database/FieldLocation.h"
+
+#include "eckit/config/Configuration.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/URI.h"
+#include "eckit/log/Log.h"
+
+#include <filesystem>
+#include <set>
+#include <system_error>
+
+namespace dasi {
+
+namespace {
+
+// A rough allowance for each cached element (key, location and URI), used against the budget
+constexpr size_t elementBytes = 256;
+
+}
+
+//-------------------------------------------------------------------------------------------------
+
+CatalogueCache::CatalogueCache(const eckit::Configuration& config) :
+    maxBytes_(config.getUnsigned("max_bytes", 0)),
+    maxAge_(config.getUnsigned("max_age_ms", 10000)) {}
+
+CatalogueCache::~CatalogueCache() {
+    LOG_DEBUG_LIB(LibDasi) << "Catalogue cache: hits=" << counters_.hits << ", misses=" << counters_.misses
+                           << ", stale=" << counters_.stale << ", evictions=" << counters_.evictions << std::endl;
+}
+
+std::shared_ptr<const CatalogueCache::Elements> CatalogueCache::get(const std::string& lookup) {
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(lookup);
+    if (it == index_.end()) {
+        ++counters_.misses;
+        return nullptr;
+    }
+
+    auto entry = it->second;
+    if (clock::now() - entry->created > maxAge_ || !current(*entry)) {
+        erase(entry);
+        ++counters_.stale;
+        ++counters_.misses;
+        return nullptr;
+    }
+
+    entries_.splice(entries_.begin(), entries_, entry);
+    ++counters_.hits;
+    return entry->elements;
+}
+
+size_t CatalogueCache::maxElements(const std::string& lookup) const {
+    const size_t empty = entryBytes(lookup, 0);
+    return maxBytes_ > empty ? (maxBytes_ - empty) / elementBytes : 0;
+}
+
+void CatalogueCache::put(const std::string& lookup, std::shared_ptr<const Elements> elements) {
+
+    if (!enabled() || !elements || elements->empty()) return;
+
+    const size_t bytes = entryBytes(lookup, elements->size());
+    if (bytes > maxBytes_) return;
+
+    // Every database holding the results must have a TOC, that we can check for changes
+
+    std::set<std::string> paths;
+    for (const auto& elem : *elements) {
+        const eckit::URI uri = elem.location().uri();
+        if (uri.scheme() != "file") return;
+        paths.insert((eckit::PathName(uri.path()).dirName() / "toc").asString());
+    }
+
+    std::vector<TocState> tocs;
+    tocs.reserve(paths.size());
+    for (const auto& path : paths) {
+        tocs.emplace_back();
+        if (!tocState(path, tocs.back())) return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto existing = index_.find(lookup);
+    if (existing != index_.end()) { erase(existing->second); }
+
+    while (!entries_.empty() && bytes_ + bytes > maxBytes_) {
+        erase(std::prev(entries_.end()));
+        ++counters_.evictions;
+    }
+
+    entries_.push_front(Entry{lookup, std::move(elements), std::move(tocs), bytes, clock::now()});
+    index_.emplace(lookup, entries_.begin());
+    bytes_ += bytes;
+}
+
+void CatalogueCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.empty()) return;
+    entries_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+CatalogueCache::Counters CatalogueCache::counters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counters_;
+}
+
+bool CatalogueCache::tocState(const std::string& path, TocState& state) {
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+
+    state.path = path;
+    state.size = size;
+    state.mtime = mtime.time_since_epoch().count();
+    return true;
+}
+
+bool CatalogueCache::current(const Entry& entry) const {
+    TocState state;
+    for (const auto& toc : entry.tocs) {
+        if (!tocState(toc.path, state)) return false;
+        if (state.size != toc.size || state.mtime != toc.mtime) return false;
+    }
+    return true;
+}
+
+void CatalogueCache::erase(std::list<Entry>::iterator it) {
+    bytes_ -= it->bytes;
+    index_.erase(it->lookup);
+    entries_.erase(it);
+}
+
+size_t CatalogueCache::entryBytes(const std::string& lookup, size_t elements) {
+    return sizeof(Entry) + 2 * lookup.size() + elements * elementBytes;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
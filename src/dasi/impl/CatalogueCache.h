@@ -0,0 +1,148 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "fdb5/api/helpers/ListIterator.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eckit { class Configuration; }
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Keeps the results of recent catalogue lookups (by list and retrieve), so that repeated queries
+/// do not re-open and re-scan the same TOC and index files. It is configured in the application
+/// configuration:
+///
+///     cache:
+///       max_bytes: 67108864   # memory budget, 0 (the default) disables the cache
+///       max_age_ms: 10000     # look up again after this long, to see new databases (default 10s)
+///
+/// The least recently used entries are evicted to keep within the budget. Results too large for the
+/// whole budget are not cached, and a list stops holding them as soon as it finds that out. The
+/// cache is cleared by any archive, flush, wipe, purge or policy change made through this process.
+/// Changes made by other processes are detected by checking, on every hit, that the TOCs of the
+/// databases holding the results are unchanged (by size and modification time).
+///
+/// Only results from TOC catalogues are cached, as others cannot be checked for changes. Empty
+/// results are not cached, as there is nothing to check.
+
+class CatalogueCache {
+
+public: // types
+
+    using Elements = std::vector<fdb5::ListElement>;
+
+    struct Counters {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t stale = 0;
+        size_t evictions = 0;
+    };
+
+public: // methods
+
+    explicit CatalogueCache(const eckit::Configuration& config);
+    ~CatalogueCache();
+
+    CatalogueCache(const CatalogueCache&) = delete;
+    CatalogueCache& operator=(const CatalogueCache&) = delete;
+
+    /// Is the cache enabled by its configuration?
+    [[ nodiscard ]]
+    bool enabled() const { return maxBytes_ > 0; }
+
+    /// The cached results of a lookup, or null if they are not cached (or are out of date)
+    [[ nodiscard ]]
+    std::shared_ptr<const Elements> get(const std::string& lookup);
+
+    /// The most elements that the results of a lookup can have, and still fit in the budget
+    [[ nodiscard ]]
+    size_t maxElements(const std::string& lookup) const;
+
+    /// Cache the results of a lookup, if they can be checked for changes and fit in the budget
+    void put(const std::string& lookup, std::shared_ptr<const Elements> elements);
+
+    /// Drop everything
+    void clear();
+
+    [[ nodiscard ]]
+    Counters counters() const;
+
+private: // types
+
+    using clock = std::chrono::steady_clock;
+
+    struct TocState {
+        std::string path;
+        uintmax_t size;
+        int64_t mtime;
+    };
+
+    struct Entry {
+        std::string lookup;
+        std::shared_ptr<const Elements> elements;
+        std::vector<TocState> tocs;
+        size_t bytes;
+        clock::time_point created;
+    };
+
+private: // methods
+
+    /// The current state of a TOC, or false if it cannot be found
+    static bool tocState(const std::string& path, TocState& state);
+
+    /// Have any of the TOCs changed since the entry was made?
+    [[ nodiscard ]]
+    bool current(const Entry& entry) const;
+
+    void erase(std::list<Entry>::iterator it);
+
+    /// The allowance for an entry against the budget
+    [[ nodiscard ]]
+    static size_t entryBytes(const std::string& lookup, size_t elements);
+
+private: // members
+
+    const size_t maxBytes_;
+    const std::chrono::milliseconds maxAge_;
+
+    mutable std::mutex mutex_;
+
+    // Most recently used first
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t bytes_ = 0;
+
+    Counters counters_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/Crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DASI_CRC32C_SSE42
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define DASI_CRC32C_ARMV8
+#include <arm_acle.h>
+#endif
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr uint32_t polynomial = 0x82f63b78;  // Reversed Castagnoli polynomial
+
+// Slicing-by-8 tables, for the software implementation
+
+using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+Tables makeTables() {
+    Tables t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int k = 0; k < 8; ++k) { crc = (crc >> 1) ^ (polynomial & (0u - (crc & 1))); }
+        t[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (size_t k = 1; k < 8; ++k) { t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff]; }
+    }
+    return t;
+}
+
+uint32_t crc32cSoftware(uint32_t crc, const unsigned char* p, size_t length) {
+
+    static const Tables t = makeTables();
+
+    while (length > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+        --length;
+    }
+
+    while (length >= 8) {
+        uint64_t word = 0;
+        for (size_t i = 0; i < 8; ++i) { word |= uint64_t(p[i]) << (8 * i); }
+        word ^= crc;
+        crc = t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^ t[4][(word >> 24) & 0xff] ^
+              t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^ t[1][(word >> 48) & 0xff] ^ t[0][word >> 56];
+        p += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0) { crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff]; }
+
+    return crc;
+}
+
+#if defined(DASI_CRC32C_SSE42)
+
+__attribute__((target("sse4.2")))
+uint32_t crc32cHardwareImpl(uint32_t crc, const unsigned char* p, size_t length) {
+
+    uint64_t crc64 = crc;
+
+    while (length > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        crc64 = _mm_crc32_u8(static_cast<uint32_t>(crc64), *p++);
+        --length;
+    }
+
+    while (length >= 8) {
+        uint64_t word;
+        ::memcpy(&word, p, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += 8;
+        length -= 8;
+    }
+
+    uint32_t crc32 = static_cast<uint32_t>(crc64);
+    while (length-- > 0) { crc32 = _mm_crc32_u8(crc32, *p++); }
+
+    return crc32;
+}
+
+bool hasHardware() {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+
+#elif defined(DASI_CRC32C_ARMV8)
+
+uint32_t crc32cHardwareImpl(uint32_t crc, const unsigned char* p, size_t length) {
+
+    while (length > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0) {
+        crc = __crc32cb(crc, *p++);
+        --length;
+    }
+
+    while (length >= 8) {
+        uint64_t word;
+        ::memcpy(&word, p, 8);
+        crc = __crc32cd(crc, word);
+        p += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0) { crc = __crc32cb(crc, *p++); }
+
+    return crc;
+}
+
+bool hasHardware() { return true; }
+
+#else
+
+uint32_t crc32cHardwareImpl(uint32_t crc, const unsigned char* p, size_t length) {
+    return crc32cSoftware(crc, p, length);
+}
+
+bool hasHardware() { return false; }
+
+#endif
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t length) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    crc = hasHardware() ? crc32cHardwareImpl(crc, p, length) : crc32cSoftware(crc, p, length);
+    return ~crc;
+}
+
+bool crc32cHardware() {
+    return hasHardware();
+}
+
+//-------------------------------------------------------------------------------------------------
+
+}  // namespace dasi
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// CRC-32C (Castagnoli), as used by iSCSI, ext4 and most object stores.
+///
+/// Uses the SSE4.2 (x86-64) or ARMv8 CRC instructions where the CPU has them, and a table-driven
+/// implementation otherwise. Checksums can be extended incrementally, starting from zero:
+///
+///     uint32_t crc = crc32c(0, part1, len1);
+///     crc = crc32c(crc, part2, len2);
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t length);
+
+/// Is the hardware implementation in use?
+bool crc32cHardware();
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/DatabaseKeys.h"
+
+#include "fdb5/rules/Schema.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include <sstream>
+
+namespace dasi {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// The keywords of the first level of each rule in a schema dump, one rule per line, such as
+/// "[ key1, key2=value, -key3, key4?default [ ... ]]". Returns false if the dump is not understood.
+bool firstLevelKeywords(const fdb5::Schema& schema, std::set<std::string>& keywords) {
+
+    std::ostringstream dump;
+    schema.dump(dump);
+
+    std::istringstream lines(dump.str());
+    std::string line;
+    size_t rules = 0;
+    while (std::getline(lines, line)) {
+
+        const auto start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] != '[') { continue; }
+
+        const auto end = line.find_first_of("[]", start + 1);
+        if (end == std::string::npos) { return false; }
+
+        std::istringstream predicates(line.substr(start + 1, end - start - 1));
+        std::string predicate;
+        while (std::getline(predicates, predicate, ',')) {
+            auto first = predicate.find_first_not_of(" \t-");
+            if (first == std::string::npos) { return false; }
+            const auto last = predicate.find_first_of(" \t:=?", first);
+            const std::string keyword = predicate.substr(first, last == std::string::npos ? last : last - first);
+            if (keyword.empty()) { return false; }
+            keywords.insert(keyword);
+        }
+        ++rules;
+    }
+
+    return rules > 0;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+DatabaseKeys::DatabaseKeys(const fdb5::Schema& schema, size_t maxDatabases) :
+    schema_(schema), maxDatabases_(maxDatabases) {
+    ASSERT(maxDatabases_ > 0);
+    remembering_ = firstLevelKeywords(schema_, keywords_);
+    if (!remembering_) { keywords_.clear(); }
+}
+
+fdb5::Key DatabaseKeys::database(const fdb5::Key& key) const {
+
+    if (!remembering()) { return expand(key); }
+
+    const std::string values = valuesOf(key);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = databases_.find(values);
+        if (it != databases_.end()) { return it->second; }
+    }
+
+    fdb5::Key dbKey = expand(key);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // A database keyword that was not found in the schema means its first level was not read
+    // correctly, and nothing can safely be remembered
+    for (const auto& kv : dbKey) {
+        if (keywords_.find(kv.first) == keywords_.end()) {
+            remembering_ = false;
+            databases_.clear();
+            return dbKey;
+        }
+    }
+
+    if (databases_.size() >= maxDatabases_) { databases_.clear(); }
+    databases_.emplace(values, dbKey);
+    return dbKey;
+}
+
+bool DatabaseKeys::remembering() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return remembering_;
+}
+
+fdb5::Key DatabaseKeys::expand(const fdb5::Key& key) const {
+    fdb5::Key dbKey;
+    if (!schema_.expandFirstLevel(key, dbKey)) {
+        std::ostringstream ss;
+        ss << "Key " << key << " does not match the first level of the schema";
+        throw eckit::UserError(ss.str(), Here());
+    }
+    return dbKey;
+}
+
+std::string DatabaseKeys::valuesOf(const fdb5::Key& key) const {
+    // Values are length-prefixed, so that no value can be mistaken for another keyword
+    std::string values;
+    for (const auto& keyword : keywords_) {
+        auto it = key.find(keyword);
+        if (it == key.end()) { continue; }
+        values += keyword;
+        values += '=';
+        values += std::to_string(it->second.size());
+        values += ':';
+        values += it->second;
+    }
+    return values;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "fdb5/database/Key.h"
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace fdb5 { class Schema; }
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Resolves the database (first-level) key of objects against a schema, without matching the
+/// schema's rules for every object.
+///
+/// The keywords used by the first level of any rule are found once, from the schema. Which rule
+/// matches, and so the database key, depends only on the values of those keywords, so resolutions
+/// are remembered by them: objects of a database share one resolution, in whatever order they come.
+/// If the schema cannot be read in this way, every object is matched against the rules.
+
+class DatabaseKeys {
+
+public: // methods
+
+    explicit DatabaseKeys(const fdb5::Schema& schema, size_t maxDatabases = defaultMaxDatabases);
+
+    /// @throws eckit::UserError if the key does not match the first level of the schema
+    [[ nodiscard ]]
+    fdb5::Key database(const fdb5::Key& key) const;
+
+    /// Were the first-level keywords found, so that resolutions are remembered?
+    [[ nodiscard ]]
+    bool remembering() const;
+
+    static constexpr size_t defaultMaxDatabases = 1024;
+
+private: // methods
+
+    fdb5::Key expand(const fdb5::Key& key) const;
+
+    std::string valuesOf(const fdb5::Key& key) const;
+
+private: // members
+
+    const fdb5::Schema& schema_;
+    const size_t maxDatabases_;
+
+    std::set<std::string> keywords_;
+    mutable bool remembering_ = false;
+
+    mutable std::mutex mutex_;
+    mutable std::map<std::string, fdb5::Key> databases_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
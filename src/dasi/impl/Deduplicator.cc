@@ -0,0 +1,137 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/Deduplicator.h"
+
+#include "dasi/lib/LibDasi.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/rules/Schema.h"
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/utils/MD5.h"
+
+#include "metkit/mars/MarsRequest.h"
+
+#include <sstream>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+Deduplicator::Deduplicator(const fdb5::Schema& schema, size_t maxOriginals) :
+    databases_(schema), maxOriginals_(maxOriginals) {
+    if (maxOriginals_ == 0) {
+        throw eckit::UserError("archive.dedup_max_objects must be greater than zero", Here());
+    }
+}
+
+bool Deduplicator::archive(const fdb5::Key& key, const void* data, size_t length) {
+
+    // The latest write to a key always wins
+
+    forget(key);
+
+    const fdb5::Key dbKey = databases_.database(key);
+
+    std::ostringstream id;
+    id << dbKey.valuesToString() << ":" << eckit::MD5(data, length).digest() << ":" << length;
+
+    auto it = originals_.find(id.str());
+    if (it != originals_.end()) {
+        recent_.splice(recent_.begin(), recent_, it->second.recent);
+        aliases_.emplace(key, it->second.key);
+        ++aliasedOriginals_[it->second.key];
+        ++duplicates_;
+        bytesSaved_ += length;
+        return true;
+    }
+
+    recent_.push_front(id.str());
+    originals_.emplace(id.str(), Original{key, recent_.begin()});
+    contents_.emplace(key, id.str());
+
+    // Aliases refer to their originals by key, so pending ones do not need them remembered
+    if (originals_.size() > maxOriginals_) {
+        erase(originals_.find(recent_.back()));
+    }
+    return false;
+}
+
+void Deduplicator::erase(std::map<std::string, Original>::iterator original) {
+    ASSERT(original != originals_.end());
+    contents_.erase(original->second.key);
+    recent_.erase(original->second.recent);
+    originals_.erase(original);
+}
+
+void Deduplicator::forget(const fdb5::Key& key) {
+
+    auto alias = aliases_.find(key);
+    if (alias != aliases_.end()) {
+        auto original = aliasedOriginals_.find(alias->second);
+        if (--original->second == 0) { aliasedOriginals_.erase(original); }
+        aliases_.erase(alias);
+    }
+
+    // Anything aliased to this key has already been resolved (see aliased())
+    ASSERT(aliasedOriginals_.find(key) == aliasedOriginals_.end());
+
+    auto content = contents_.find(key);
+    if (content != contents_.end()) {
+        erase(originals_.find(content->second));
+    }
+}
+
+void Deduplicator::resolve(fdb5::FDB& fdb) {
+
+    if (aliases_.empty()) return;
+
+    std::map<fdb5::Key, fdb5::ListElement> locations;
+
+    for (const auto& alias : aliases_) {
+
+        auto it = locations.find(alias.second);
+        if (it == locations.end()) {
+            metkit::mars::MarsRequest request("retrieve");
+            for (const auto& kv : alias.second) { request.setValue(kv.first, kv.second); }
+
+            fdb5::ListElement elem;
+            auto iter = fdb.inspect(request);
+            if (!iter.next(elem)) {
+                std::ostringstream ss;
+                ss << "Original of deduplicated object " << alias.first << " not found: " << alias.second;
+                throw eckit::SeriousBug(ss.str(), Here());
+            }
+            it = locations.emplace(alias.second, elem).first;
+        }
+
+        fdb.reindex(alias.first, it->second.location());
+    }
+
+    aliases_.clear();
+    aliasedOriginals_.clear();
+
+    LOG_DEBUG_LIB(LibDasi) << "Deduplicated " << duplicates_ << " objects, saving " << bytesSaved_ << " bytes"
+                           << std::endl;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/impl/DatabaseKeys.h"
+
+#include "fdb5/database/Key.h"
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+
+namespace fdb5 { class FDB; class Schema; }
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Detects objects that are byte-identical to one already archived (in this session) into the same
+/// database. Rather than being written again, the duplicate is recorded as an alias, and indexed to
+/// the location of the original once that has been flushed.
+///
+/// Objects are identified by the MD5 digest and length of their content. The bytes themselves are
+/// not compared, so two different objects with the same length and digest would be taken to be
+/// the same. Only the most recently archived originals are remembered, so that the memory used
+/// does not grow with the session.
+
+class Deduplicator {
+
+public: // methods
+
+    /// @param maxOriginals The number of originals to remember. Duplicates of the least recently
+    ///                     archived or matched are written again.
+    Deduplicator(const fdb5::Schema& schema, size_t maxOriginals);
+
+    /// Called for every object archived. Returns true if it is a duplicate, and must not be
+    /// written. Otherwise, it is remembered as an original.
+    bool archive(const fdb5::Key& key, const void* data, size_t length);
+
+    /// Must an alias be resolved before this key is overwritten (as it is the original that it
+    /// refers to)?
+    [[ nodiscard ]]
+    bool aliased(const fdb5::Key& key) const { return aliasedOriginals_.find(key) != aliasedOriginals_.end(); }
+
+    /// Are there aliases waiting to be indexed?
+    [[ nodiscard ]]
+    bool pending() const { return !aliases_.empty(); }
+
+    /// Index the aliases to the locations of their originals. The originals must have been flushed.
+    void resolve(fdb5::FDB& fdb);
+
+    /// Called for an object archived without its content being seen, which replaces whatever was
+    /// remembered for its key. Any aliases to the key must have been resolved.
+    void forget(const fdb5::Key& key);
+
+private: // types
+
+    struct Original {
+        fdb5::Key key;
+        std::list<std::string>::iterator recent;
+    };
+
+private: // methods
+
+    void erase(std::map<std::string, Original>::iterator original);
+
+private: // members
+
+    const DatabaseKeys databases_;
+
+    // Database + digest + length -> the original, with the most recently used at the front
+    std::map<std::string, Original> originals_;
+    std::map<fdb5::Key, std::string> contents_;
+    std::list<std::string> recent_;
+    size_t maxOriginals_;
+
+    // Alias -> original, waiting to be indexed
+    std::map<fdb5::Key, fdb5::Key> aliases_;
+    std::map<fdb5::Key, size_t> aliasedOriginals_;
+
+    size_t duplicates_ = 0;
+    size_t bytesSaved_ = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/DirectStore.h"
+
+#include "fdb5/config/Config.h"
+#include "fdb5/database/FieldLocation.h"
+#include "fdb5/database/Key.h"
+#include "fdb5/database/Store.h"
+
+#include "eckit/filesystem/PathName.h"
+
+namespace dasi {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::unique_ptr<fdb5::Store> openStore(const fdb5::Config& config, const fdb5::Key& database) {
+
+    auto store = fdb5::StoreFactory::instance().build(config.schema(), database, config);
+
+    const eckit::URI uri = store->uri();
+    if (uri.scheme() == "file") {
+        eckit::PathName directory(uri.path());
+        if (!directory.exists()) { directory.mkdir(); }
+    }
+
+    return store;
+}
+
+std::unique_ptr<fdb5::FieldLocation> partOf(const fdb5::FieldLocation& location, size_t offset, size_t length) {
+    const eckit::Offset start = static_cast<long long>(location.offset()) + static_cast<long long>(offset);
+    return std::unique_ptr<fdb5::FieldLocation>(fdb5::FieldLocationFactory::instance().build(
+            location.uri().scheme(), location.uri(), start, length, fdb5::Key()));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi
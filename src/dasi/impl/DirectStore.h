@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace fdb5 { class Config; class FieldLocation; class Key; class Store; }
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+// Objects are normally written through the FDB, which indexes each where it was stored. Streamed
+// and combined objects are written to the store of their database directly, and indexed (with
+// FDB::reindex()) once complete, at a location chosen by DASI.
+
+/// Open the store of a database for writing, creating the database's directory if need be. Its
+/// catalogue is only created when the first object is indexed, but the data must be stored first.
+std::unique_ptr<fdb5::Store> openStore(const fdb5::Config& config, const fdb5::Key& database);
+
+/// The location of part of what was stored at a location
+std::unique_ptr<fdb5::FieldLocation> partOf(const fdb5::FieldLocation& location, size_t offset, size_t length);
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// 64-bit FNV-1a. It is byte-oriented, so gives the same result on every platform and in every
+/// process, and is used where hashes are shared or persisted.
+
+constexpr uint64_t fnv1aOffsetBasis = 0xcbf29ce484222325ULL;
+constexpr uint64_t fnv1aPrime = 0x100000001b3ULL;
+
+inline uint64_t fnv1a(uint64_t hash, const void* data, size_t length) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= p[i];
+        hash *= fnv1aPrime;
+    }
+    return hash;
+}
+
+/// Hash a string, followed by a terminator, so that consecutive strings are not ambiguous
+inline uint64_t fnv1a(uint64_t hash, std::string_view s, unsigned char terminator = 0) {
+    hash = fnv1a(hash, s.data(), s.size());
+    hash ^= terminator;
+    return hash * fnv1aPrime;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
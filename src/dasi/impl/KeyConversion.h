@@ -0,0 +1,70 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/api/Key.h"
+
+#include "fdb5/database/Key.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+template <typename ForEach>
+void assignKey(Key& key, ForEach&& forEach) {
+    // Consecutive elements of a listing almost always have the same keywords, and values that fit
+    // in the existing strings, so updating in place does not allocate
+    size_t count = 0;
+    forEach([&key, &count](const std::string& k, const std::string& v) {
+        key.set(k, v);
+        ++count;
+    });
+    // Keywords are only ever added above, so any others must be removed by starting again
+    if (key.size() != count) {
+        key.clear();
+        forEach([&key](const std::string& k, const std::string& v) { key.set(k, v); });
+    }
+}
+
+}  // namespace detail
+
+/// Update a key in place to hold the keywords and values of an FDB key, reusing its storage
+inline void assignKey(Key& key, const fdb5::Key& fdbKey) {
+    detail::assignKey(key, [&fdbKey](auto&& fn) {
+        for (const auto& kv : fdbKey) { fn(kv.first, kv.second); }
+    });
+}
+
+/// Update a key in place to hold the keywords and values of a list of FDB (sub)keys
+inline void assignKey(Key& key, const std::vector<fdb5::Key>& fdbKeys) {
+    detail::assignKey(key, [&fdbKeys](auto&& fn) {
+        for (const auto& subkey : fdbKeys) {
+            for (const auto& kv : subkey) { fn(kv.first, kv.second); }
+        }
+    });
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
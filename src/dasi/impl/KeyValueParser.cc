@@ -0,0 +1,139 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/KeyValueParser.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include <sstream>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+KeyValueParser::KeyValueParser(std::string_view input, const char* what, bool multipleValues) :
+    input_(input), what_(what), multipleValues_(multipleValues) {}
+
+bool KeyValueParser::nextKeyword(std::string_view& keyword) {
+
+    std::string_view skipped;
+    while (inValues_) { nextValue(skipped); }
+
+    while (pos_ < input_.size() && input_[pos_] == ',') { ++pos_; }
+    if (pos_ == input_.size()) return false;
+
+    const size_t start = pos_;
+    bool quoted = false;
+    keyword = token(keywordScratch_, quoted);
+    if (keyword.empty() && !quoted) fail("empty keyword", start);
+
+    if (pos_ == input_.size() || input_[pos_] != '=') fail("expected '='", pos_);
+    ++pos_;
+
+    inValues_ = true;
+    firstValue_ = true;
+    return true;
+}
+
+bool KeyValueParser::nextValue(std::string_view& value) {
+
+    if (!inValues_) return false;
+
+    if (!firstValue_) {
+        if (pos_ == input_.size() || input_[pos_] == ',') {
+            inValues_ = false;
+            return false;
+        }
+        if (input_[pos_] == '=') fail("unexpected '='", pos_);
+        // Must be a '/'
+        if (!multipleValues_) fail("unexpected '/' (multiple values are only allowed in a query)", pos_);
+        ++pos_;
+    }
+
+    const size_t start = pos_;
+    bool quoted = false;
+    value = token(valueScratch_, quoted);
+    if (value.empty() && !quoted) fail("empty value", start);
+
+    firstValue_ = false;
+    return true;
+}
+
+std::string_view KeyValueParser::token(std::string& scratch, bool& quoted) {
+
+    const size_t start = pos_;
+
+    // Most tokens are plain, and are returned without copying
+
+    while (pos_ < input_.size()) {
+        const char c = input_[pos_];
+        if (isDelimiter(c) || c == '\\' || c == '"' || c == '\'') break;
+        ++pos_;
+    }
+
+    if (pos_ == input_.size() || isDelimiter(input_[pos_])) {
+        return input_.substr(start, pos_ - start);
+    }
+
+    scratch.assign(input_.data() + start, pos_ - start);
+
+    while (pos_ < input_.size()) {
+        const char c = input_[pos_];
+        if (isDelimiter(c)) break;
+
+        if (c == '\\') {
+            if (pos_ + 1 == input_.size()) fail("trailing escape character", pos_);
+            scratch += input_[pos_ + 1];
+            pos_ += 2;
+        } else if (c == '"' || c == '\'') {
+            quoted = true;
+            const size_t open = pos_++;
+            for (;;) {
+                if (pos_ == input_.size()) fail("unterminated quote", open);
+                const char q = input_[pos_];
+                if (q == c) {
+                    ++pos_;
+                    break;
+                }
+                if (q == '\\' && c == '"') {
+                    if (pos_ + 1 == input_.size()) fail("unterminated quote", open);
+                    scratch += input_[pos_ + 1];
+                    pos_ += 2;
+                } else {
+                    scratch += q;
+                    ++pos_;
+                }
+            }
+        } else {
+            scratch += c;
+            ++pos_;
+        }
+    }
+
+    return scratch;
+}
+
+void KeyValueParser::fail(const char* message, size_t position) const {
+    std::ostringstream ss;
+    ss << "Invalid " << what_ << " \"" << input_ << "\": " << message << " at position " << position;
+    throw eckit::UserError(ss.str(), Here());
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Single-pass parser for the string forms of keys and queries:
+///
+///     keyword=value,keyword=value1/value2,...
+///
+/// A `,`, `=` or `/` (or any other character) is taken literally if preceded by a backslash, or
+/// within single or double quotes. Within double quotes, a backslash still escapes the next
+/// character. Empty pairs (as in `a=1,,b=2` or a trailing comma) are ignored.
+///
+/// Tokens are returned as views of the input, and are only copied (into a buffer owned by the
+/// parser) if they contain escapes or quotes. Errors are reported as eckit::UserError, with the
+/// position in the input.
+
+class KeyValueParser {
+
+public: // methods
+
+    /// @param what What is being parsed, for error messages ("key", "query")
+    /// @param multipleValues Are `/`-separated lists of values allowed?
+    KeyValueParser(std::string_view input, const char* what, bool multipleValues);
+
+    /// Parse the next keyword. Any values of the previous keyword not yet read are skipped.
+    /// @returns false at the end of the input
+    bool nextKeyword(std::string_view& keyword);
+
+    /// Parse the next value of the current keyword. The first call after nextKeyword() always
+    /// succeeds. The view is valid until the next call.
+    /// @returns false once all values of the current keyword have been read
+    bool nextValue(std::string_view& value);
+
+private: // methods
+
+    static bool isDelimiter(char c) { return c == ',' || c == '=' || c == '/'; }
+
+    /// Read a token, up to the next unescaped delimiter
+    std::string_view token(std::string& scratch, bool& quoted);
+
+    [[ noreturn ]]
+    void fail(const char* message, size_t position) const;
+
+private: // members
+
+    std::string_view input_;
+    const char* what_;
+    bool multipleValues_;
+
+    size_t pos_ = 0;
+    bool inValues_ = false;
+    bool firstValue_ = false;
+
+    // Only used for tokens that are escaped or quoted
+    std::string keywordScratch_;
+    std::string valueScratch_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
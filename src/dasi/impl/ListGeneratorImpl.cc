@@ -1,41 +1,117 @@
 
 #include "ListGeneratorImpl.h"
 
+#include "dasi/impl/KeyConversion.h"
+#include "dasi/impl/ObjectEncoding.h"
+
 namespace dasi {
 
 //-------------------------------------------------------------------------------------------------
 
-ListGeneratorImpl::ListGeneratorImpl(fdb5::ListIterator&& iter) :
+ListGeneratorImpl::ListGeneratorImpl(fdb5::ListIterator&& iter, const ListOptions& options,
+                                     std::shared_ptr<const ObjectEncoder> encoder) :
+    APIGeneratorImpl<ListElement>(),
+    iter_(std::move(iter)),
+    options_(options),
+    encoder_(std::move(encoder)),
+    done_(false) {
+    ListGeneratorImpl::next();
+}
+
+ListGeneratorImpl::ListGeneratorImpl(std::vector<fdb5::ListElement>&& head, fdb5::ListIterator&& iter,
+                                     const ListOptions& options, std::shared_ptr<const ObjectEncoder> encoder) :
     APIGeneratorImpl<ListElement>(),
+    head_(std::move(head)),
     iter_(std::move(iter)),
+    options_(options),
+    encoder_(std::move(encoder)),
     done_(false) {
     ListGeneratorImpl::next();
 }
 
+void ListGeneratorImpl::convert(const fdb5::ListElement& from, ListElement& to, ListFields fields,
+                                const ObjectEncoder* encoder) {
+    assignKey(to.key, from.key());
+    if (fields == ListFields::Keys) return;
+    to.timestamp = from.timestamp();
+    if (fields == ListFields::KeysAndTimestamp) return;
+    to.location.uri = from.location().uri();
+    to.location.offset = from.location().offset();
+    if (encoder && encoder->encoded(from.key()[0])) {
+        const auto stored = ObjectEncoder::inspect(from);
+        to.location.length = stored.length;
+        to.checksum = stored.checksum;
+    } else {
+        to.location.length = from.location().length();
+        to.checksum.reset();
+    }
+}
+
 void ListGeneratorImpl::next() {
     if (!done_) {
-        if (iter_.next(fdb5Element_)) {
-            Key key;
-            for (const auto& subkey : fdb5Element_.key()) {
-                for (const auto& kv : subkey) {
-                    key.set(kv.first, kv.second);
-                }
+        // Older elements are skipped before any conversion
+        while (nextElement()) {
+            if (fdb5Element_.timestamp() >= options_.since) {
+                convert(fdb5Element_, dasiElement_, options_.fields, encoder_.get());
+                return;
             }
-            dasiElement_.key = std::move(key);
-            dasiElement_.timestamp = fdb5Element_.timestamp();
-            dasiElement_.location.uri = fdb5Element_.location().uri();
-            dasiElement_.location.offset = fdb5Element_.location().offset();
-            dasiElement_.location.length = fdb5Element_.location().length();
-        } else {
-            done_ = true;
         }
+        done_ = true;
     }
 }
 
+bool ListGeneratorImpl::nextElement() {
+    if (headPosition_ < head_.size()) {
+        fdb5Element_ = std::move(head_[headPosition_++]);
+        // Release the head once it has been listed
+        if (headPosition_ == head_.size()) {
+            std::vector<fdb5::ListElement>().swap(head_);
+            headPosition_ = 0;
+        }
+        return true;
+    }
+    return iter_.next(fdb5Element_);
+}
+
 const ListElement& ListGeneratorImpl::value() const { return dasiElement_; }
 
 bool ListGeneratorImpl::done() const { return done_; }
 
 //-------------------------------------------------------------------------------------------------
 
+CachedListGeneratorImpl::CachedListGeneratorImpl(std::shared_ptr<const std::vector<fdb5::ListElement>> elements,
+                                                 const ListOptions& options,
+                                                 std::shared_ptr<const ObjectEncoder> encoder) :
+    APIGeneratorImpl<ListElement>(),
+    elements_(std::move(elements)),
+    iter_(elements_->begin()),
+    options_(options),
+    encoder_(std::move(encoder)),
+    done_(false) {
+    while (iter_ != elements_->end() && iter_->timestamp() < options_.since) { ++iter_; }
+    update();
+}
+
+void CachedListGeneratorImpl::next() {
+    if (!done_) {
+        do {
+            ++iter_;
+        } while (iter_ != elements_->end() && iter_->timestamp() < options_.since);
+        update();
+    }
+}
+
+void CachedListGeneratorImpl::update() {
+    done_ = (iter_ == elements_->end());
+    if (!done_) {
+        ListGeneratorImpl::convert(*iter_, dasiElement_, options_.fields, encoder_.get());
+    }
+}
+
+const ListElement& CachedListGeneratorImpl::value() const { return dasiElement_; }
+
+bool CachedListGeneratorImpl::done() const { return done_; }
+
+//-------------------------------------------------------------------------------------------------
+
 }  // namespace dasi
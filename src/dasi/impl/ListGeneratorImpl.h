@@ -8,15 +8,33 @@
 #include "dasi/api/detail/Generators.h"
 #include "dasi/api/detail/ListDetail.h"
 
+#include <memory>
+#include <vector>
+
 namespace dasi {
 
+class ObjectEncoder;
+
 //-------------------------------------------------------------------------------------------------
 
 class ListGeneratorImpl : public APIGeneratorImpl<ListElement> {
 
 public: // methods
 
-    explicit ListGeneratorImpl(fdb5::ListIterator&& iter);
+    /// @param options The details of the elements to fill in, and which elements to return
+    /// @param encoder Report the decoded length and checksum of objects in the spaces it encodes,
+    ///                which requires reading the start of each of them. If nullptr, all the objects
+    ///                are reported as stored.
+    explicit ListGeneratorImpl(fdb5::ListIterator&& iter, const ListOptions& options={},
+                               std::shared_ptr<const ObjectEncoder> encoder=nullptr);
+
+    /// List the elements already taken from the start of an iterator, and then the rest of it
+    ListGeneratorImpl(std::vector<fdb5::ListElement>&& head, fdb5::ListIterator&& iter,
+                      const ListOptions& options={}, std::shared_ptr<const ObjectEncoder> encoder=nullptr);
+
+    /// Fill in a DASI list element from an FDB one, reusing its storage
+    static void convert(const fdb5::ListElement& from, ListElement& to, ListFields fields,
+                        const ObjectEncoder* encoder);
 
     void next() override;
 
@@ -26,11 +44,54 @@ public: // methods
     [[ nodiscard ]]
     bool done() const override;
 
+private: // methods
+
+    /// The next FDB element, from the head and then from the iterator
+    bool nextElement();
+
 private: // members
 
     fdb5::ListElement fdb5Element_;
     dasi::ListElement dasiElement_;
+    std::vector<fdb5::ListElement> head_;
+    size_t headPosition_ = 0;
     fdb5::ListIterator iter_;
+    ListOptions options_;
+    std::shared_ptr<const ObjectEncoder> encoder_;
+    bool done_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+/// Lists the elements of an earlier lookup, held by the catalogue cache
+
+class CachedListGeneratorImpl : public APIGeneratorImpl<ListElement> {
+
+public: // methods
+
+    explicit CachedListGeneratorImpl(std::shared_ptr<const std::vector<fdb5::ListElement>> elements,
+                                     const ListOptions& options={},
+                                     std::shared_ptr<const ObjectEncoder> encoder=nullptr);
+
+    void next() override;
+
+    [[ nodiscard ]]
+    const ListElement& value() const override;
+
+    [[ nodiscard ]]
+    bool done() const override;
+
+private: // methods
+
+    void update();
+
+private: // members
+
+    std::shared_ptr<const std::vector<fdb5::ListElement>> elements_;
+    std::vector<fdb5::ListElement>::const_iterator iter_;
+    dasi::ListElement dasiElement_;
+    ListOptions options_;
+    std::shared_ptr<const ObjectEncoder> encoder_;
     bool done_;
 };
 
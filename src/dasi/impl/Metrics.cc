@@ -0,0 +1,134 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/Metrics.h"
+
+#include <algorithm>
+#include <ostream>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+size_t latencyBucket(Metrics::clock::duration elapsed) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    size_t bucket = 0;
+    for (auto v = uint64_t(us > 0 ? us : 0); v != 0; v >>= 1) { ++bucket; }
+    return std::min(bucket, OperationStats::latencyBuckets - 1);
+}
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+size_t Metrics::shardIndex() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % numShards;
+    return index;
+}
+
+void Metrics::record(Operation op, size_t bytes, clock::duration elapsed) {
+    auto& counters = shards_[shardIndex()].ops[op];
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                   std::memory_order_relaxed);
+    counters.latency[latencyBucket(elapsed)].fetch_add(1, std::memory_order_relaxed);
+}
+
+Stats Metrics::snapshot() const {
+
+    std::array<OperationStats, NumOperations> ops;
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < NumOperations; ++i) {
+            const auto& counters = shard.ops[i];
+            ops[i].calls += counters.calls.load(std::memory_order_relaxed);
+            ops[i].bytes += counters.bytes.load(std::memory_order_relaxed);
+            ops[i].seconds += counters.nanoseconds.load(std::memory_order_relaxed) * 1e-9;
+            for (size_t b = 0; b < OperationStats::latencyBuckets; ++b) {
+                ops[i].latency[b] += counters.latency[b].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Stats stats;
+    stats.archive = ops[Archive];
+    stats.flush = ops[Flush];
+    stats.list = ops[List];
+    stats.retrieve = ops[Retrieve];
+    stats.wipe = ops[Wipe];
+    stats.purge = ops[Purge];
+    stats.read = ops[Read];
+    return stats;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+MeteredHandle::MeteredHandle(eckit::DataHandle* handle, std::shared_ptr<Metrics> metrics) :
+    handle_(handle), metrics_(std::move(metrics)) {}
+
+MeteredHandle::~MeteredHandle() = default;
+
+eckit::Length MeteredHandle::openForRead() {
+    return handle_->openForRead();
+}
+
+long MeteredHandle::read(void* buffer, long length) {
+    auto timer = metrics_->time(Metrics::Read);
+    const long nread = handle_->read(buffer, length);
+    if (nread > 0) { timer.addBytes(nread); }
+    return nread;
+}
+
+void MeteredHandle::close() {
+    handle_->close();
+}
+
+eckit::Length MeteredHandle::estimate() {
+    return handle_->estimate();
+}
+
+eckit::Length MeteredHandle::size() {
+    return handle_->size();
+}
+
+bool MeteredHandle::canSeek() const {
+    return handle_->canSeek();
+}
+
+eckit::Offset MeteredHandle::seek(const eckit::Offset& offset) {
+    return handle_->seek(offset);
+}
+
+void MeteredHandle::skip(const eckit::Length& length) {
+    handle_->skip(length);
+}
+
+eckit::Offset MeteredHandle::position() {
+    return handle_->position();
+}
+
+void MeteredHandle::print(std::ostream& s) const {
+    s << "MeteredHandle[" << *handle_ << "]";
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
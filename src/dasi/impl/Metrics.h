@@ -0,0 +1,138 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/api/detail/StatsDetail.h"
+
+#include "eckit/io/DataHandle.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Operation counters and latency histograms, recorded without locks.
+///
+/// Each thread records into one of a fixed number of cache-line aligned shards, with relaxed
+/// atomic increments, so that threads archiving concurrently do not contend. The shards are
+/// summed when a snapshot is taken.
+
+class Metrics {
+
+public: // types
+
+    enum Operation { Archive = 0, Flush, List, Retrieve, Wipe, Purge, Read, NumOperations };
+
+    using clock = std::chrono::steady_clock;
+
+    /// Records a call when it goes out of scope (including by an exception)
+    class Timer {
+    public:
+        Timer(Metrics& metrics, Operation op, size_t bytes = 0) :
+            metrics_(metrics), op_(op), bytes_(bytes), start_(clock::now()) {}
+        ~Timer() { metrics_.record(op_, bytes_, clock::now() - start_); }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        void addBytes(size_t bytes) { bytes_ += bytes; }
+
+    private:
+        Metrics& metrics_;
+        Operation op_;
+        size_t bytes_;
+        clock::time_point start_;
+    };
+
+public: // methods
+
+    void record(Operation op, size_t bytes, clock::duration elapsed);
+
+    [[ nodiscard ]]
+    Timer time(Operation op, size_t bytes = 0) { return Timer(*this, op, bytes); }
+
+    /// Sum the shards. Flush trigger counts are not recorded here.
+    [[ nodiscard ]]
+    Stats snapshot() const;
+
+private: // types
+
+    static constexpr size_t numShards = 16;
+
+    struct Counters {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> nanoseconds{0};
+        std::array<std::atomic<uint64_t>, OperationStats::latencyBuckets> latency{};
+    };
+
+    struct alignas(64) Shard {
+        std::array<Counters, NumOperations> ops;
+    };
+
+private: // methods
+
+    static size_t shardIndex();
+
+private: // members
+
+    std::array<Shard, numShards> shards_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+/// Records the reads from a retrieve result's data handle
+
+class MeteredHandle : public eckit::DataHandle {
+
+public: // methods
+
+    MeteredHandle(eckit::DataHandle* handle, std::shared_ptr<Metrics> metrics);
+    ~MeteredHandle() override;
+
+    eckit::Length openForRead() override;
+    long read(void* buffer, long length) override;
+    void close() override;
+
+    eckit::Length estimate() override;
+    eckit::Length size() override;
+
+    bool canSeek() const override;
+    eckit::Offset seek(const eckit::Offset& offset) override;
+    void skip(const eckit::Length& length) override;
+    eckit::Offset position() override;
+
+private: // methods
+
+    void print(std::ostream& s) const override;
+
+private: // members
+
+    std::unique_ptr<eckit::DataHandle> handle_;
+    std::shared_ptr<Metrics> metrics_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,584 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/ObjectEncoding.h"
+
+#include "dasi/impl/Crc32c.h"
+
+#include "fdb5/api/helpers/ListIterator.h"
+#include "fdb5/database/Key.h"
+#include "fdb5/rules/Schema.h"
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/utils/Compressor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Envelope layout (all integers little-endian):
+//
+//   0  magic "DASIZ\0"
+//   6  uint16 version
+//   8  codec name, NUL padded ("none" if stored uncompressed)
+//  16  uint64 logical length
+//  24  uint32 chunk bytes (logical)
+//  28  uint32 chunk count
+//  32  uint32 flags
+//  36  uint32 CRC-32C of the logical data, if flagged
+//  40  uint64 stored length of each chunk
+//  ..  chunks
+
+constexpr char envelopeMagic[6] = {'D', 'A', 'S', 'I', 'Z', '\0'};
+constexpr uint16_t envelopeVersion = 1;
+constexpr size_t envelopeFixedBytes = 40;
+constexpr size_t envelopeCodecBytes = 8;
+
+constexpr uint32_t flagChecksum = 0x1;
+
+constexpr size_t defaultChunkBytes = 4 * 1024 * 1024;
+
+template <typename T>
+void putLE(unsigned char* p, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) { p[i] = static_cast<unsigned char>(value >> (8 * i)); }
+}
+
+template <typename T>
+T getLE(const unsigned char* p) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) { value |= static_cast<T>(p[i]) << (8 * i); }
+    return value;
+}
+
+struct EnvelopeHeader {
+    std::string codec;
+    uint64_t logicalLength;
+    uint32_t chunkBytes;
+    uint32_t chunkCount;
+    std::optional<uint32_t> checksum;
+
+    size_t headerBytes() const { return envelopeFixedBytes + 8 * size_t(chunkCount); }
+};
+
+/// Does this look like an envelope header? The chunk table is checked separately, once read.
+bool parseHeader(const unsigned char* p, EnvelopeHeader& header) {
+
+    if (::memcmp(p, envelopeMagic, sizeof(envelopeMagic)) != 0) return false;
+    if (getLE<uint16_t>(p + 6) != envelopeVersion) return false;
+
+    const char* codec = reinterpret_cast<const char*>(p + 8);
+    header.codec.assign(codec, ::strnlen(codec, envelopeCodecBytes));
+    header.logicalLength = getLE<uint64_t>(p + 16);
+    header.chunkBytes = getLE<uint32_t>(p + 24);
+    header.chunkCount = getLE<uint32_t>(p + 28);
+
+    const uint32_t flags = getLE<uint32_t>(p + 32);
+    if (flags & ~flagChecksum) return false;
+    header.checksum.reset();
+    if (flags & flagChecksum) { header.checksum = getLE<uint32_t>(p + 36); }
+
+    if (header.codec.empty() || header.chunkBytes == 0) return false;
+    return header.chunkCount == (header.logicalLength + header.chunkBytes - 1) / header.chunkBytes;
+}
+
+bool checkChunkTable(const unsigned char* table, const EnvelopeHeader& header, eckit::Length physicalLength,
+                     std::vector<uint64_t>& sizes) {
+    sizes.resize(header.chunkCount);
+    uint64_t total = header.headerBytes();
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        sizes[i] = getLE<uint64_t>(table + 8 * i);
+        total += sizes[i];
+    }
+    return physicalLength == eckit::Length(0) || total == uint64_t(physicalLength);
+}
+
+size_t readFully(eckit::DataHandle& handle, void* buffer, size_t length) {
+    size_t total = 0;
+    while (total < length) {
+        const long nread = handle.read(static_cast<char*>(buffer) + total, length - total);
+        if (nread <= 0) break;
+        total += nread;
+    }
+    return total;
+}
+
+/// Read the envelope from the start of an object, leaving the handle at the first chunk
+void readEnvelope(eckit::DataHandle& handle, eckit::Length physicalLength, EnvelopeHeader& header,
+                  std::vector<uint64_t>& sizes) {
+
+    unsigned char fixed[envelopeFixedBytes];
+    if (readFully(handle, fixed, sizeof(fixed)) != sizeof(fixed) || !parseHeader(fixed, header) ||
+        (physicalLength != eckit::Length(0) && header.headerBytes() > size_t(physicalLength))) {
+        throw eckit::ReadError("No valid envelope at the start of " + handle.title(), Here());
+    }
+
+    std::vector<unsigned char> table(8 * size_t(header.chunkCount));
+    if (readFully(handle, table.data(), table.size()) != table.size() ||
+        !checkChunkTable(table.data(), header, physicalLength, sizes)) {
+        throw eckit::ReadError("Invalid chunk table in the envelope of " + handle.title(), Here());
+    }
+}
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+ObjectEncoder::ObjectEncoder(const fdb5::Config& config) :
+    config_(config),
+    databaseKeys_(config_.schema()),
+    default_{"none", defaultChunkBytes, std::max(1u, std::thread::hardware_concurrency()), false} {
+
+    if (config.has("compression")) { default_ = parseSettings(config, "compression", default_); }
+    default_.checksum = config.getBool("checksum", false);
+    enabled_ = default_.encoded();
+
+    if (config.has("spaces")) {
+        for (const auto& space : config.getSubConfigurations("spaces")) {
+            Settings settings = space.has("compression") ? parseSettings(space, "compression", default_) : default_;
+            settings.checksum = space.getBool("checksum", default_.checksum);
+            enabled_ |= settings.encoded();
+            spaces_.emplace_back(eckit::Regex(space.getString("select", ".*")), std::move(settings));
+        }
+    }
+}
+
+ObjectEncoder::Settings ObjectEncoder::parseSettings(const eckit::Configuration& config, const std::string& name,
+                                                     const Settings& defaults) {
+
+    Settings settings = defaults;
+
+    if (config.isSubConfiguration(name)) {
+        const auto section = config.getSubConfiguration(name);
+        settings.type = section.getString("type", defaults.type);
+        settings.chunkBytes = section.getUnsigned("chunk_bytes", defaults.chunkBytes);
+        settings.threads = section.getUnsigned("threads", defaults.threads);
+        if (section.has("level")) {
+            eckit::Log::warning() << "Compression level is not supported by the " << settings.type
+                                  << " compressor, and is ignored" << std::endl;
+        }
+    } else {
+        settings.type = config.getString(name);
+    }
+
+    if (settings.type != "none" && !eckit::CompressorFactory::instance().has(settings.type)) {
+        std::ostringstream ss;
+        ss << "Compression type '" << settings.type << "' is not available. Available types: ";
+        eckit::CompressorFactory::instance().list(ss);
+        throw eckit::UserError(ss.str(), Here());
+    }
+
+    if (settings.type.size() > envelopeCodecBytes) {
+        throw eckit::UserError("Compression type name '" + settings.type + "' is too long", Here());
+    }
+
+    if (settings.chunkBytes == 0 || settings.chunkBytes > std::numeric_limits<uint32_t>::max()) {
+        throw eckit::UserError("Compression chunk_bytes must be between 1 byte and 4 GiB", Here());
+    }
+
+    settings.threads = std::max(settings.threads, size_t(1));
+    return settings;
+}
+
+const ObjectEncoder::Settings& ObjectEncoder::settings(const fdb5::Key& key) const {
+
+    return databaseSettings(databaseKeys_.database(key));
+}
+
+const ObjectEncoder::Settings& ObjectEncoder::databaseSettings(const fdb5::Key& dbKey) const {
+
+    // Spaces are selected in the same way as by the FDB, on the values of the database key
+    const std::string database = dbKey.valuesToString();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = databases_.find(database);
+    if (it == databases_.end()) {
+        const Settings* selected = &default_;
+        for (const auto& space : spaces_) {
+            if (space.first.match(database)) {
+                selected = &space.second;
+                break;
+            }
+        }
+        it = databases_.emplace(database, selected).first;
+    }
+    return *it->second;
+}
+
+bool ObjectEncoder::encoded(const fdb5::Key& database) const {
+    return enabled_ && databaseSettings(database).encoded();
+}
+
+std::unique_ptr<eckit::Buffer> ObjectEncoder::encode(const fdb5::Key& key, const void* data, size_t length,
+                                                     size_t& encodedLength) const {
+
+    const Settings& settings = this->settings(key);
+    if (!settings.encoded()) return nullptr;
+    const bool checksum = settings.checksum;
+    const bool compress = (settings.type != "none" && length > 0);
+
+    const size_t chunkBytes = settings.chunkBytes;
+    const size_t nchunks = (length + chunkBytes - 1) / chunkBytes;
+    const auto* input = static_cast<const char*>(data);
+
+    // Chunks are compressed independently, so large objects are shared out across threads. The
+    // checksum is computed alongside, on this thread.
+
+    std::vector<std::unique_ptr<eckit::Buffer>> chunks(nchunks);
+    std::vector<size_t> sizes(nchunks);
+
+    if (compress) {
+        auto work = [&](size_t first, size_t stride) {
+            std::unique_ptr<eckit::Compressor> compressor(eckit::CompressorFactory::instance().build(settings.type));
+            for (size_t i = first; i < nchunks; i += stride) {
+                const size_t offset = i * chunkBytes;
+                const size_t len = std::min(chunkBytes, length - offset);
+                chunks[i] = std::make_unique<eckit::Buffer>(len);
+                sizes[i] = compressor->compress(input + offset, len, *chunks[i]);
+            }
+        };
+
+        const size_t workers = std::min(settings.threads, nchunks);
+        std::vector<std::future<void>> futures;
+        for (size_t w = 0; w < workers; ++w) {
+            futures.push_back(std::async(workers > 1 ? std::launch::async : std::launch::deferred, work, w, workers));
+        }
+        const uint32_t crc = checksum ? crc32c(0, data, length) : 0;
+        for (auto& future : futures) { future.get(); }
+
+        size_t total = envelopeFixedBytes + 8 * nchunks;
+        for (size_t size : sizes) { total += size; }
+
+        if (total < length) {
+            auto result = std::make_unique<eckit::Buffer>(total);
+            auto* p = static_cast<unsigned char*>(result->data());
+            size_t offset = envelopeFixedBytes + 8 * nchunks;
+            for (size_t i = 0; i < nchunks; ++i) {
+                putLE<uint64_t>(p + envelopeFixedBytes + 8 * i, sizes[i]);
+                ::memcpy(p + offset, chunks[i]->data(), sizes[i]);
+                offset += sizes[i];
+            }
+            writeHeader(p, settings.type, length, chunkBytes, nchunks, checksum, crc);
+            encodedLength = total;
+            return result;
+        }
+
+        // Incompressible data is stored uncompressed, still in an envelope as are all the objects
+        // of the space
+    }
+
+    const size_t total = envelopeFixedBytes + 8 * nchunks + length;
+    auto result = std::make_unique<eckit::Buffer>(total);
+    auto* p = static_cast<unsigned char*>(result->data());
+    for (size_t i = 0; i < nchunks; ++i) {
+        putLE<uint64_t>(p + envelopeFixedBytes + 8 * i, std::min(chunkBytes, length - i * chunkBytes));
+    }
+    if (length > 0) { ::memcpy(p + envelopeFixedBytes + 8 * nchunks, data, length); }
+    writeHeader(p, "none", length, chunkBytes, nchunks, checksum, checksum ? crc32c(0, data, length) : 0);
+
+    encodedLength = total;
+    return result;
+}
+
+std::unique_ptr<EncodeStream> ObjectEncoder::encodeStream(const fdb5::Key& key) const {
+    if (!enabled_) return nullptr;
+    const Settings& settings = this->settings(key);
+    if (!settings.encoded()) return nullptr;
+    return std::make_unique<EncodeStream>(settings.type, settings.chunkBytes, settings.checksum);
+}
+
+void ObjectEncoder::writeHeader(unsigned char* p, const std::string& codec, size_t length, size_t chunkBytes,
+                                size_t nchunks, bool checksum, uint32_t crc) {
+    ::memset(p, 0, envelopeFixedBytes);
+    ::memcpy(p, envelopeMagic, sizeof(envelopeMagic));
+    putLE<uint16_t>(p + 6, envelopeVersion);
+    ::memcpy(p + 8, codec.data(), codec.size());
+    putLE<uint64_t>(p + 16, length);
+    putLE<uint32_t>(p + 24, chunkBytes);
+    putLE<uint32_t>(p + 28, nchunks);
+    if (checksum) {
+        putLE<uint32_t>(p + 32, flagChecksum);
+        putLE<uint32_t>(p + 36, crc);
+    }
+}
+
+StoredObject ObjectEncoder::inspect(const fdb5::ListElement& elem) {
+
+    std::unique_ptr<eckit::DataHandle> handle(elem.location().dataHandle());
+    handle->openForRead();
+    eckit::AutoClose closer(*handle);
+
+    EnvelopeHeader header;
+    std::vector<uint64_t> sizes;
+    readEnvelope(*handle, elem.location().length(), header, sizes);
+
+    return StoredObject{header.logicalLength, header.checksum};
+}
+
+//-------------------------------------------------------------------------------------------------
+
+EncodeStream::EncodeStream(const std::string& codec, size_t chunkBytes, bool checksum) :
+    codec_(codec), chunkBytes_(chunkBytes), checksum_(checksum) {
+    if (codec_ != "none") { compressor_.reset(eckit::CompressorFactory::instance().build(codec_)); }
+}
+
+EncodeStream::~EncodeStream() = default;
+
+void EncodeStream::write(const void* data, size_t length) {
+
+    if (checksum_) { crc_ = crc32c(crc_, data, length); }
+    length_ += length;
+
+    const auto* input = static_cast<const char*>(data);
+    while (length > 0) {
+        if (!pending_) {
+            pending_ = std::make_unique<eckit::Buffer>(chunkBytes_);
+            pendingLength_ = 0;
+        }
+        const size_t n = std::min(length, chunkBytes_ - pendingLength_);
+        ::memcpy(static_cast<char*>(pending_->data()) + pendingLength_, input, n);
+        pendingLength_ += n;
+        input += n;
+        length -= n;
+        if (pendingLength_ == chunkBytes_) { storeChunk(); }
+    }
+}
+
+void EncodeStream::storeChunk() {
+
+    if (compressor_) {
+        // Held at its compressed size, and the chunk buffer is reused for the next chunk
+        const size_t size = compressor_->compress(pending_->data(), pendingLength_, compressed_);
+        auto chunk = std::make_unique<eckit::Buffer>(size);
+        ::memcpy(chunk->data(), compressed_.data(), size);
+        chunks_.push_back(std::move(chunk));
+        sizes_.push_back(size);
+    } else {
+        chunks_.push_back(std::move(pending_));
+        sizes_.push_back(pendingLength_);
+    }
+    pendingLength_ = 0;
+}
+
+std::unique_ptr<eckit::Buffer> EncodeStream::finish(size_t& encodedLength) {
+
+    if (pendingLength_ > 0) { storeChunk(); }
+    pending_.reset();
+
+    const size_t nchunks = chunks_.size();
+    size_t total = envelopeFixedBytes + 8 * nchunks;
+    for (size_t size : sizes_) { total += size; }
+
+    // Chunks are released as they are copied, so the object is not held twice
+    auto result = std::make_unique<eckit::Buffer>(total);
+    auto* p = static_cast<unsigned char*>(result->data());
+    size_t offset = envelopeFixedBytes + 8 * nchunks;
+    for (size_t i = 0; i < nchunks; ++i) {
+        putLE<uint64_t>(p + envelopeFixedBytes + 8 * i, sizes_[i]);
+        ::memcpy(p + offset, chunks_[i]->data(), sizes_[i]);
+        offset += sizes_[i];
+        chunks_[i].reset();
+    }
+    ObjectEncoder::writeHeader(p, compressor_ ? codec_ : "none", length_, chunkBytes_, nchunks, checksum_, crc_);
+
+    chunks_.clear();
+    sizes_.clear();
+
+    encodedLength = total;
+    return result;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+DecodeHandle::DecodeHandle(eckit::DataHandle* handle, eckit::Length logicalLength, bool verify) :
+    handle_(handle), logicalLength_(logicalLength), verify_(verify) {}
+
+DecodeHandle::~DecodeHandle() = default;
+
+eckit::Length DecodeHandle::openForRead() {
+
+    const eckit::Length physicalLength = handle_->openForRead();
+
+    compressor_.reset();
+    chunkSizes_.clear();
+    storedChecksum_.reset();
+    checksum_.reset();
+    crc_ = 0;
+    nextChunk_ = 0;
+    chunkLength_ = 0;
+    chunkPos_ = 0;
+    open_ = true;
+    position_ = 0;
+
+    EnvelopeHeader header;
+    readEnvelope(*handle_, physicalLength, header, chunkSizes_);
+
+    if (header.codec != "none") {
+        if (!eckit::CompressorFactory::instance().has(header.codec)) {
+            throw eckit::ReadError("Object in " + handle_->title() + " is compressed with " + header.codec +
+                                   ", which is not available", Here());
+        }
+        compressor_.reset(eckit::CompressorFactory::instance().build(header.codec));
+    }
+    headerBytes_ = header.headerBytes();
+    chunkBytes_ = header.chunkBytes;
+    remaining_ = header.logicalLength;
+    logicalLength_ = header.logicalLength;
+    storedChecksum_ = header.checksum;
+    if (verify_) { checksum_ = storedChecksum_; }
+
+    return logicalLength_;
+}
+
+long DecodeHandle::read(void* buffer, long length) {
+
+    char* out = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (total < length) {
+        if (chunkPos_ == chunkLength_ && !readChunk()) break;
+
+        const size_t n = std::min(size_t(length - total), chunkLength_ - chunkPos_);
+        ::memcpy(out + total, static_cast<const char*>(chunk_.data()) + chunkPos_, n);
+        chunkPos_ += n;
+        total += n;
+    }
+
+    position_ += total;
+    return total;
+}
+
+bool DecodeHandle::readChunk() {
+
+    if (nextChunk_ == chunkSizes_.size()) return false;
+
+    const size_t storedLength = chunkSizes_[nextChunk_++];
+    const size_t logicalLength = std::min(chunkBytes_, remaining_);
+
+    if (compressor_) {
+        if (compressed_.size() < storedLength) { compressed_.resize(storedLength); }
+        if (readFully(*handle_, compressed_.data(), storedLength) != storedLength) {
+            throw eckit::ReadError("Truncated object in " + handle_->title(), Here());
+        }
+        if (chunk_.size() < logicalLength) { chunk_.resize(logicalLength); }
+        compressor_->uncompress(compressed_.data(), storedLength, chunk_, logicalLength);
+    } else {
+        ASSERT(storedLength == logicalLength);
+        if (chunk_.size() < logicalLength) { chunk_.resize(logicalLength); }
+        if (readFully(*handle_, chunk_.data(), logicalLength) != logicalLength) {
+            throw eckit::ReadError("Truncated object in " + handle_->title(), Here());
+        }
+    }
+
+    remaining_ -= logicalLength;
+    chunkLength_ = logicalLength;
+    chunkPos_ = 0;
+
+    if (checksum_) {
+        crc_ = crc32c(crc_, chunk_.data(), logicalLength);
+        if (nextChunk_ == chunkSizes_.size() && crc_ != *checksum_) {
+            std::ostringstream ss;
+            ss << "Checksum mismatch in " << handle_->title() << ": expected " << std::hex << std::setfill('0')
+               << std::setw(8) << *checksum_ << ", got " << std::setw(8) << crc_;
+            throw eckit::ReadError(ss.str(), Here());
+        }
+    }
+
+    return true;
+}
+
+void DecodeHandle::close() {
+    handle_->close();
+    open_ = false;
+}
+
+eckit::Length DecodeHandle::estimate() {
+    return logicalLength_ != eckit::Length(0) ? logicalLength_ : handle_->estimate();
+}
+
+eckit::Length DecodeHandle::size() {
+    if (!open_ && logicalLength_ == eckit::Length(0)) {
+        openForRead();
+        close();
+    }
+    return logicalLength_;
+}
+
+bool DecodeHandle::canSeek() const {
+    return handle_->canSeek();
+}
+
+eckit::Offset DecodeHandle::seek(const eckit::Offset& offset) {
+
+    ASSERT(open_);
+    const size_t pos = std::min(size_t(offset), size_t(logicalLength_));
+
+    chunkLength_ = 0;
+    chunkPos_ = 0;
+
+    crc_ = 0;
+    checksum_ = (pos == 0 && verify_) ? storedChecksum_ : std::nullopt;
+
+    const size_t chunk = std::min(pos / chunkBytes_, chunkSizes_.size());
+    size_t stored = headerBytes_;
+    for (size_t i = 0; i < chunk; ++i) { stored += chunkSizes_[i]; }
+    handle_->seek(stored);
+
+    nextChunk_ = chunk;
+    remaining_ = size_t(logicalLength_) - std::min(size_t(logicalLength_), chunk * chunkBytes_);
+    if (readChunk()) { chunkPos_ = pos - chunk * chunkBytes_; }
+
+    position_ = pos;
+    return pos;
+}
+
+void DecodeHandle::skip(const eckit::Length& length) {
+    if (canSeek()) {
+        seek(position_ + size_t(length));
+        return;
+    }
+    char buffer[64 * 1024];
+    size_t left = length;
+    while (left > 0) {
+        const long nread = read(buffer, long(std::min(left, sizeof(buffer))));
+        if (nread <= 0) break;
+        left -= nread;
+    }
+}
+
+eckit::Offset DecodeHandle::position() {
+    return position_;
+}
+
+void DecodeHandle::print(std::ostream& s) const {
+    s << "DecodeHandle[" << *handle_ << "]";
+}
+
+//-------------------------------------------------------------------------------------------------
+
+}  // namespace dasi
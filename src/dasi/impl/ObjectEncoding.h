@@ -0,0 +1,264 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/impl/DatabaseKeys.h"
+
+#include "fdb5/config/Config.h"
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/utils/Regex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace eckit { class Compressor; class Configuration; }
+namespace fdb5 { class Key; class ListElement; }
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// What is known about a stored object, from its envelope (if it has one)
+struct StoredObject {
+    eckit::Length length;
+    std::optional<uint32_t> checksum;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+class EncodeStream;
+
+/// Encodes objects for storage, wrapping them in an envelope if they are compressed or checksummed.
+///
+/// Compression and checksums are configured in the DASI configuration, as they describe how the
+/// data is stored, either at the top level or per space:
+///
+///     compression:
+///       type: lz4          # any eckit compressor, or none
+///       chunk_bytes: 4194304
+///       threads: 4
+///     checksum: true       # store a CRC-32C of each object
+///
+/// A space entry uses its own `compression` section and `checksum` (if it has them) for the
+/// databases matched by its `select` regex, as the FDB does when choosing the space. The short form
+/// `compression: lz4` is also accepted.
+///
+/// The envelope records the codec, the logical length and (optionally) a CRC-32C of the logical
+/// data, and is followed by independently compressed chunks. Large objects are compressed with a
+/// chunk per thread. Objects that do not get smaller are stored uncompressed in the envelope.
+///
+/// Every object in a space with compression or checksums is stored in an envelope, and the objects
+/// in other spaces are stored as they are. Whether an object has an envelope is known from its
+/// space, not by looking at its data, so data that happens to start like an envelope is returned as
+/// it was archived. The configuration of a space must therefore not change once it holds data.
+
+class ObjectEncoder {
+
+public: // methods
+
+    explicit ObjectEncoder(const fdb5::Config& config);
+
+    /// Are any objects encoded?
+    [[ nodiscard ]]
+    bool enabled() const { return enabled_; }
+
+    /// Are the objects of this database (the first-level key) configured to be compressed or
+    /// checksummed?
+    [[ nodiscard ]]
+    bool encoded(const fdb5::Key& database) const;
+
+    /// Encode the object as configured for its database. Returns nullptr if its space is neither
+    /// compressed nor checksummed, so the object is stored unchanged.
+    [[ nodiscard ]]
+    std::unique_ptr<eckit::Buffer> encode(const fdb5::Key& key, const void* data, size_t length,
+                                          size_t& encodedLength) const;
+
+    /// Start encoding an object that is written in pieces, as configured for its database. Returns
+    /// nullptr if its space is neither compressed nor checksummed.
+    [[ nodiscard ]]
+    std::unique_ptr<EncodeStream> encodeStream(const fdb5::Key& key) const;
+
+    /// The logical (decoded) length and checksum of an object stored in an envelope, which is read
+    /// @throws eckit::ReadError if the object does not start with a valid envelope
+    [[ nodiscard ]]
+    static StoredObject inspect(const fdb5::ListElement& elem);
+
+private: // types
+
+    friend class EncodeStream;
+
+    struct Settings {
+        std::string type;
+        size_t chunkBytes;
+        size_t threads;
+        bool checksum;
+
+        bool encoded() const { return checksum || type != "none"; }
+    };
+
+private: // methods
+
+    static Settings parseSettings(const eckit::Configuration& config, const std::string& name, const Settings& defaults);
+
+    static void writeHeader(unsigned char* p, const std::string& codec, size_t length, size_t chunkBytes,
+                            size_t nchunks, bool checksum, uint32_t crc);
+
+    /// The settings for an object's key, or for the key of its database
+    const Settings& settings(const fdb5::Key& key) const;
+    const Settings& databaseSettings(const fdb5::Key& database) const;
+
+private: // members
+
+    const fdb5::Config config_;
+    const DatabaseKeys databaseKeys_;
+
+    Settings default_;
+    std::vector<std::pair<eckit::Regex, Settings>> spaces_;
+
+    // Used by the archiving and listing threads
+    mutable std::mutex mutex_;
+    mutable std::map<std::string, const Settings*> databases_;
+
+    bool enabled_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+/// Encodes an object that is written in pieces. Each chunk is compressed as soon as it is complete,
+/// so only the compressed chunks are held until the object is finished and the envelope, which
+/// precedes them, can be written.
+///
+/// Unlike ObjectEncoder::encode(), the chunks are compressed on the writing thread, and an object
+/// that does not get smaller is still stored compressed, as its uncompressed data is not kept. In a
+/// space with checksums but no compression, the whole object is held.
+
+class EncodeStream {
+
+public: // methods
+
+    EncodeStream(const std::string& codec, size_t chunkBytes, bool checksum);
+    ~EncodeStream();
+
+    void write(const void* data, size_t length);
+
+    /// The encoded object, once all of it has been written
+    [[ nodiscard ]]
+    std::unique_ptr<eckit::Buffer> finish(size_t& encodedLength);
+
+private: // methods
+
+    void storeChunk();
+
+private: // members
+
+    std::string codec_;
+    size_t chunkBytes_;
+    bool checksum_;
+
+    std::unique_ptr<eckit::Compressor> compressor_;  // nullptr if stored uncompressed
+    eckit::Buffer compressed_;
+
+    // The chunk being filled
+    std::unique_ptr<eckit::Buffer> pending_;
+    size_t pendingLength_ = 0;
+
+    std::vector<std::unique_ptr<eckit::Buffer>> chunks_;
+    std::vector<size_t> sizes_;
+
+    uint32_t crc_ = 0;
+    size_t length_ = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+/// Reads an object stored in an envelope, decoding it chunk by chunk.
+///
+/// Sizes and positions are those of the decoded data. Seeking (if the underlying handle can) moves
+/// to the start of the chunk holding the new position and decodes from there. The checksum can
+/// only be verified by reading from the start, so is not checked after seeking elsewhere.
+
+class DecodeHandle : public eckit::DataHandle {
+
+public: // methods
+
+    /// @param logicalLength The length of the decoded data, if known from the listing
+    /// @param verify Check the checksum, if there is one. A mismatch is reported by the read that
+    ///               reaches the end of the object.
+    /// Opening the handle throws eckit::ReadError if the object does not start with a valid envelope.
+    DecodeHandle(eckit::DataHandle* handle, eckit::Length logicalLength = 0, bool verify = true);
+    ~DecodeHandle() override;
+
+    eckit::Length openForRead() override;
+    long read(void* buffer, long length) override;
+    void close() override;
+
+    eckit::Length estimate() override;
+
+    /// Opens the object to read the envelope, if the length is not yet known
+    eckit::Length size() override;
+
+    bool canSeek() const override;
+    eckit::Offset seek(const eckit::Offset& offset) override;
+    void skip(const eckit::Length& length) override;
+    eckit::Offset position() override;
+
+private: // methods
+
+    void print(std::ostream& s) const override;
+
+    bool readChunk();
+
+private: // members
+
+    std::unique_ptr<eckit::DataHandle> handle_;
+    eckit::Length logicalLength_;
+    bool verify_;
+
+    std::unique_ptr<eckit::Compressor> compressor_;  // nullptr if stored uncompressed
+    size_t headerBytes_ = 0;
+    size_t chunkBytes_ = 0;
+    std::vector<uint64_t> chunkSizes_;
+    size_t nextChunk_ = 0;
+    size_t remaining_ = 0;
+
+    std::optional<uint32_t> storedChecksum_;
+    std::optional<uint32_t> checksum_;  // Only set while it is being verified
+    uint32_t crc_ = 0;
+
+    // Decoded data not yet returned
+    eckit::Buffer chunk_;
+    eckit::Buffer compressed_;
+    size_t chunkLength_ = 0;
+    size_t chunkPos_ = 0;
+
+    bool open_ = false;
+    size_t position_ = 0;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/PagedListGeneratorImpl.h"
+
+#include "dasi/api/Serialisation.h"
+#include "dasi/impl/KeyConversion.h"
+#include "dasi/impl/ListGeneratorImpl.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include <algorithm>
+
+namespace dasi {
+
+namespace {
+
+const char hexDigits[] = "0123456789abcdef";
+
+/// Cursors are hex encoded, so that they can be passed around as text (e.g. in URLs)
+std::string encodeCursor(const std::vector<fdb5::Key>& parts) {
+    Encoder encoder;
+    Key key;
+    for (const auto& part : parts) {
+        assignKey(key, part);
+        encoder.encode(key);
+    }
+    const auto& buffer = encoder.buffer();
+    std::string cursor;
+    cursor.reserve(2 * buffer.size());
+    for (unsigned char c : buffer) {
+        cursor += hexDigits[c >> 4];
+        cursor += hexDigits[c & 0xf];
+    }
+    return cursor;
+}
+
+std::vector<fdb5::Key> decodeCursor(const std::string& cursor) {
+
+    auto invalid = [&cursor] { return eckit::UserError("Invalid list cursor: " + cursor, Here()); };
+
+    auto nibble = [&invalid](char c) -> unsigned {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        throw invalid();
+    };
+
+    if (cursor.size() % 2 != 0) throw invalid();
+    std::string data;
+    data.reserve(cursor.size() / 2);
+    for (size_t i = 0; i < cursor.size(); i += 2) {
+        data += static_cast<char>((nibble(cursor[i]) << 4) | nibble(cursor[i + 1]));
+    }
+
+    std::vector<fdb5::Key> parts;
+    try {
+        Decoder decoder(data.data(), data.size());
+        while (!decoder.done()) {
+            fdb5::Key part;
+            for (const auto& kv : decoder.decodeKey()) { part.set(kv.first, kv.second); }
+            parts.push_back(std::move(part));
+        }
+    } catch (const eckit::UserError&) {
+        throw invalid();
+    }
+    if (parts.empty()) throw invalid();
+    return parts;
+}
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+PagedListGeneratorImpl::PagedListGeneratorImpl(const fdb5::Config& config, const metkit::mars::MarsRequest& request,
+                                               const ListOptions& options,
+                                               std::shared_ptr<const ObjectEncoder> encoder) :
+    fdb_(config),
+    request_(request),
+    options_(options),
+    encoder_(std::move(encoder)) {
+
+    if (!options_.cursor.empty()) {
+        // Resume in the cursor's database, even if the object it refers to is no longer there
+        after_ = cursorKey(options_.cursor, request_);
+        database_ = after_[0];
+        more_ = true;
+    }
+
+    PagedListGeneratorImpl::next();
+}
+
+std::vector<fdb5::Key> PagedListGeneratorImpl::cursorKey(const std::string& cursor,
+                                                         const metkit::mars::MarsRequest& request) {
+    auto parts = decodeCursor(cursor);
+
+    // The cursor's database must be one that the request could list
+    for (const auto& kv : parts[0]) {
+        if (!request.has(kv.first)) continue;
+        const auto& values = request.values(kv.first);
+        if (std::find(values.begin(), values.end(), kv.second) == values.end()) {
+            throw eckit::UserError("List cursor is from a list with a different query: " + cursor, Here());
+        }
+    }
+    return parts;
+}
+
+bool PagedListGeneratorImpl::nextDatabase() {
+    if (!haveDatabases_) {
+        // Once each, even if present under several roots
+        auto&& iter = fdb_.status(fdb5::FDBToolRequest(request_));
+        fdb5::StatusElement elem;
+        while (iter.next(elem)) { databases_.push_back(elem.key); }
+        std::sort(databases_.begin(), databases_.end());
+        databases_.erase(std::unique(databases_.begin(), databases_.end()), databases_.end());
+        haveDatabases_ = true;
+    }
+
+    auto it = database_ ? std::upper_bound(databases_.begin(), databases_.end(), *database_) : databases_.begin();
+    if (it == databases_.end()) return false;
+
+    database_ = *it;
+    after_.clear();
+    return true;
+}
+
+void PagedListGeneratorImpl::loadBatch() {
+    metkit::mars::MarsRequest request(request_);
+    for (const auto& kv : *database_) { request.setValue(kv.first, kv.second); }
+
+    bool deduplicate = true;
+    auto&& iter = fdb_.list(fdb5::FDBToolRequest(request), deduplicate);
+
+    // Only the elements that could be on this page (and one more, to know if there is another) are
+    // kept, in a heap with the largest key at the front
+    const size_t keep = options_.limit > 0 ? options_.limit - returned_ + 1 : 0;
+    auto byKey = [](const fdb5::ListElement& lhs, const fdb5::ListElement& rhs) { return lhs.key() < rhs.key(); };
+
+    batch_.clear();
+    batchPosition_ = 0;
+    more_ = false;
+
+    fdb5::ListElement elem;
+    while (iter.next(elem)) {
+        if (elem.timestamp() < options_.since) continue;
+        if (!after_.empty() && !(after_ < elem.key())) continue;
+        if (keep > 0 && batch_.size() == keep) {
+            more_ = true;
+            if (!(elem.key() < batch_.front().key())) continue;
+            std::pop_heap(batch_.begin(), batch_.end(), byKey);
+            batch_.back() = elem;
+        } else {
+            batch_.push_back(elem);
+        }
+        std::push_heap(batch_.begin(), batch_.end(), byKey);
+    }
+    std::sort_heap(batch_.begin(), batch_.end(), byKey);
+}
+
+bool PagedListGeneratorImpl::fetch(fdb5::ListElement& elem) {
+    while (true) {
+        if (batchPosition_ < batch_.size()) {
+            elem = batch_[batchPosition_++];
+            return true;
+        }
+        if (more_) {
+            // Carry on in the same database, after the last of its elements taken
+            if (!batch_.empty()) { after_ = batch_.back().key(); }
+        } else if (!nextDatabase()) {
+            return false;
+        }
+        loadBatch();
+    }
+}
+
+void PagedListGeneratorImpl::next() {
+    if (done_) return;
+
+    if (options_.limit > 0 && returned_ == options_.limit) {
+        // Look ahead, so that the last page does not give a cursor to an empty one
+        fdb5::ListElement elem;
+        complete_ = !fetch(elem);
+        done_ = true;
+        return;
+    }
+
+    if (fetch(fdb5Element_)) {
+        ListGeneratorImpl::convert(fdb5Element_, dasiElement_, options_.fields, encoder_.get());
+        ++returned_;
+    } else {
+        done_ = true;
+        complete_ = true;
+    }
+}
+
+const ListElement& PagedListGeneratorImpl::value() const { return dasiElement_; }
+
+bool PagedListGeneratorImpl::done() const { return done_; }
+
+std::string PagedListGeneratorImpl::cursor() const {
+    if (complete_) return {};
+    ASSERT(returned_ > 0);
+    return encodeCursor(fdb5Element_.key());
+}
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/api/detail/Generators.h"
+#include "dasi/api/detail/ListDetail.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/ListIterator.h"
+#include "fdb5/database/Key.h"
+
+#include "metkit/mars/MarsRequest.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dasi {
+
+class ObjectEncoder;
+
+//-------------------------------------------------------------------------------------------------
+
+/// Lists a page of at most ListOptions::limit elements, starting after ListOptions::cursor, and
+/// provides the cursor from which the next page starts.
+///
+/// The elements are listed in the order of their keys (the database part, then the index and datum
+/// parts), which does not depend on the order in which the FDB visits them. A cursor holds the key
+/// of the last element returned, and a page starts with the elements after it, so objects archived
+/// (or re-archived) concurrently are neither repeated nor skipped, unless their keys come before the
+/// cursor.
+///
+/// The FDB cannot start a listing part way through a database, so each page passes over the listing
+/// of the cursor's database, keeping only the smallest keys after the cursor that could be on the
+/// page (or all of them, without a limit). The other databases matching the request are only looked
+/// up, by walking the database statuses, when a page continues past the cursor's database.
+
+class PagedListGeneratorImpl : public APIGeneratorImpl<ListElement> {
+
+public: // methods
+
+    /// @param config The configuration of the FDB to list. The listing uses its own FDB, as the
+    ///               generator outlives the call to Dasi::list().
+    /// @throws eckit::UserError if the cursor is invalid, or from a list with a different request
+    PagedListGeneratorImpl(const fdb5::Config& config, const metkit::mars::MarsRequest& request,
+                           const ListOptions& options, std::shared_ptr<const ObjectEncoder> encoder=nullptr);
+
+    void next() override;
+
+    [[ nodiscard ]]
+    const ListElement& value() const override;
+
+    [[ nodiscard ]]
+    bool done() const override;
+
+    /// The cursor from which to resume after the current element, or empty if there are no more
+    [[ nodiscard ]]
+    std::string cursor() const override;
+
+    /// The key (database, index and datum parts) of the element a cursor refers to
+    /// @throws eckit::UserError if the cursor is invalid, or from a list with a different request
+    [[ nodiscard ]]
+    static std::vector<fdb5::Key> cursorKey(const std::string& cursor, const metkit::mars::MarsRequest& request);
+
+private: // methods
+
+    /// The next element matching the options, in order of keys across the databases
+    bool fetch(fdb5::ListElement& elem);
+
+    /// Take the elements of the current database after after_, in order, into the batch
+    void loadBatch();
+
+    /// Move on to the database after the current one (or to the first)
+    bool nextDatabase();
+
+private: // members
+
+    fdb5::FDB fdb_;
+    const metkit::mars::MarsRequest request_;
+    const ListOptions options_;
+    const std::shared_ptr<const ObjectEncoder> encoder_;
+
+    // The databases matching the request, sorted. Only looked up when they are needed.
+    std::vector<fdb5::Key> databases_;
+    bool haveDatabases_ = false;
+
+    // The database being listed, and the key after which its next batch starts (empty for the start)
+    std::optional<fdb5::Key> database_;
+    std::vector<fdb5::Key> after_;
+
+    std::vector<fdb5::ListElement> batch_;
+    size_t batchPosition_ = 0;
+    // Were elements of the current database left out of the batch?
+    bool more_ = false;
+
+    // The last element returned
+    fdb5::ListElement fdb5Element_;
+    dasi::ListElement dasiElement_;
+
+    size_t returned_ = 0;
+    bool done_ = false;
+    bool complete_ = false;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
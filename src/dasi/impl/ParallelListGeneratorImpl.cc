@@ -0,0 +1,210 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/ParallelListGeneratorImpl.h"
+
+#include "dasi/impl/ListGeneratorImpl.h"
+
+#include "fdb5/api/FDB.h"
+#include "fdb5/api/helpers/FDBToolRequest.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Elements buffered per channel before the workers feeding it wait for the consumer
+constexpr size_t channelCapacity = 1024;
+
+}  // namespace
+
+//-------------------------------------------------------------------------------------------------
+
+class ParallelListGeneratorImpl::Channel {
+
+public: // methods
+
+    Channel(size_t producers, const std::atomic<bool>& cancelled) : producers_(producers), cancelled_(cancelled) {}
+
+    /// Returns false if the listing has been cancelled
+    bool push(ListElement&& element) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return elements_.size() < channelCapacity || cancelled_; });
+        if (cancelled_) return false;
+        elements_.push_back(std::move(element));
+        cv_.notify_all();
+        return true;
+    }
+
+    /// Called once by each producer, when it has finished
+    void close(std::exception_ptr error = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ASSERT(producers_ > 0);
+        --producers_;
+        if (error && !error_) error_ = error;
+        cv_.notify_all();
+    }
+
+    /// Returns false once every producer has finished, and the elements have been consumed
+    bool pop(ListElement& element) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !elements_.empty() || producers_ == 0 || error_; });
+        if (error_) std::rethrow_exception(error_);
+        if (elements_.empty()) return false;
+        element = std::move(elements_.front());
+        elements_.pop_front();
+        cv_.notify_all();
+        return true;
+    }
+
+    void wake() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+    }
+
+private: // members
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<ListElement> elements_;
+    size_t producers_;
+    std::exception_ptr error_;
+    const std::atomic<bool>& cancelled_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+ParallelListGeneratorImpl::ParallelListGeneratorImpl(const fdb5::Config& config,
+                                                     const metkit::mars::MarsRequest& request,
+                                                     std::vector<fdb5::Key>&& databases, size_t threads,
+                                                     bool ordered, const ListOptions& options,
+                                                     std::shared_ptr<const ObjectEncoder> encoder) :
+    config_(config),
+    request_(request),
+    databases_(std::move(databases)),
+    ordered_(ordered),
+    options_(options),
+    encoder_(std::move(encoder)) {
+
+    ASSERT(threads > 0);
+
+    if (ordered_) {
+        for (size_t i = 0; i < databases_.size(); ++i) {
+            channels_.emplace_back(std::make_unique<Channel>(1, cancelled_));
+        }
+    } else {
+        channels_.emplace_back(std::make_unique<Channel>(databases_.size(), cancelled_));
+    }
+
+    threads = std::min(threads, databases_.size());
+    workers_.reserve(threads);
+    try {
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+        ParallelListGeneratorImpl::next();
+    } catch (...) {
+        // The destructor is not run, but the workers must still be stopped
+        cancel();
+        throw;
+    }
+}
+
+ParallelListGeneratorImpl::~ParallelListGeneratorImpl() {
+    cancel();
+}
+
+void ParallelListGeneratorImpl::cancel() {
+    cancelled_ = true;
+    for (auto& channel : channels_) { channel->wake(); }
+    for (auto& worker : workers_) { worker.join(); }
+    workers_.clear();
+}
+
+void ParallelListGeneratorImpl::work() {
+
+    // Databases are taken in order, so (for ordered output) the one being consumed has always been
+    // taken by a worker, which is not waiting for any other
+
+    std::unique_ptr<fdb5::FDB> fdb;
+    size_t index;
+    while (!cancelled_ && (index = nextDatabase_++) < databases_.size()) {
+        auto& channel = *channels_[ordered_ ? index : 0];
+        try {
+            if (!fdb) { fdb = std::make_unique<fdb5::FDB>(config_); }
+            listDatabase(*fdb, index);
+            channel.close();
+        } catch (...) {
+            channel.close(std::current_exception());
+        }
+    }
+
+    // Close the channels of any databases that will not now be listed
+    while (ordered_ && (index = nextDatabase_++) < databases_.size()) {
+        channels_[index]->close();
+    }
+}
+
+void ParallelListGeneratorImpl::listDatabase(fdb5::FDB& fdb, size_t index) {
+
+    metkit::mars::MarsRequest request(request_);
+    for (const auto& kv : databases_[index]) { request.setValue(kv.first, kv.second); }
+
+    auto& channel = *channels_[ordered_ ? index : 0];
+
+    bool deduplicate = true;
+    auto iter = fdb.list(fdb5::FDBToolRequest(request), deduplicate);
+
+    fdb5::ListElement elem;
+    while (iter.next(elem)) {
+        if (elem.timestamp() < options_.since) continue;
+        ListElement element;
+        ListGeneratorImpl::convert(elem, element, options_.fields, encoder_.get());
+        if (!channel.push(std::move(element))) return;
+    }
+}
+
+void ParallelListGeneratorImpl::next() {
+    while (!done_) {
+        if (channels_.empty() || currentChannel_ == channels_.size()) {
+            done_ = true;
+            cancel();
+        } else if (channels_[currentChannel_]->pop(element_)) {
+            return;
+        } else {
+            ++currentChannel_;
+        }
+    }
+}
+
+const ListElement& ParallelListGeneratorImpl::value() const { return element_; }
+
+bool ParallelListGeneratorImpl::done() const { return done_; }
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/api/detail/Generators.h"
+#include "dasi/api/detail/ListDetail.h"
+
+#include "fdb5/config/Config.h"
+#include "fdb5/database/Key.h"
+
+#include "metkit/mars/MarsRequest.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace fdb5 { class FDB; }
+
+namespace dasi {
+
+class ObjectEncoder;
+
+//-------------------------------------------------------------------------------------------------
+
+/// Lists a number of databases in parallel. Worker threads, each with their own FDB instance, take
+/// the databases in turn and stream the elements back to the consuming thread through bounded
+/// queues. It is configured in the application configuration:
+///
+///     list:
+///       threads: 8        # list this many databases at a time (1, the default, lists serially)
+///       ordered: true     # return the databases one at a time, in order (the default)
+///
+/// Ordered output buffers each database separately, and returns them in the order in which they
+/// were found, as a serial list would. Unordered output returns elements as soon as any worker
+/// produces them, so a slow database does not hold up the others. Errors raised by a worker are
+/// rethrown by the consumer.
+
+class ParallelListGeneratorImpl : public APIGeneratorImpl<ListElement> {
+
+public: // methods
+
+    /// @param databases The (first-level) keys of the databases matching the request
+    ParallelListGeneratorImpl(const fdb5::Config& config, const metkit::mars::MarsRequest& request,
+                              std::vector<fdb5::Key>&& databases, size_t threads, bool ordered,
+                              const ListOptions& options={},
+                              std::shared_ptr<const ObjectEncoder> encoder=nullptr);
+
+    /// Stops the workers, if the listing is abandoned early
+    ~ParallelListGeneratorImpl() override;
+
+    void next() override;
+
+    [[ nodiscard ]]
+    const ListElement& value() const override;
+
+    [[ nodiscard ]]
+    bool done() const override;
+
+private: // types
+
+    class Channel;
+
+private: // methods
+
+    void work();
+    void listDatabase(fdb5::FDB& fdb, size_t index);
+    void cancel();
+
+private: // members
+
+    const fdb5::Config config_;
+    const metkit::mars::MarsRequest request_;
+    const std::vector<fdb5::Key> databases_;
+    const bool ordered_;
+    const ListOptions options_;
+    const std::shared_ptr<const ObjectEncoder> encoder_;
+
+    /// One per database if ordered, otherwise shared by all the databases
+    std::vector<std::unique_ptr<Channel>> channels_;
+    size_t currentChannel_ = 0;
+
+    std::atomic<size_t> nextDatabase_{0};
+    std::atomic<bool> cancelled_{false};
+    std::vector<std::thread> workers_;
+
+    ListElement element_;
+    bool done_ = false;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
@@ -1,6 +1,8 @@
 
 #include "PolicyStatusGeneratorImpl.h"
 
+#include "dasi/impl/KeyConversion.h"
+
 namespace dasi {
 
 //-------------------------------------------------------------------------------------------------
@@ -17,12 +19,7 @@ PolicyStatusGeneratorImpl::PolicyStatusGeneratorImpl(fdb5::StatusIterator&& iter
 void PolicyStatusGeneratorImpl::next() {
     if (!done_) {
         if (iter_.next(fdb5Element_)) {
-            /// @todo Write a sensibly placed function to do this for all the adapters
-            Key key;
-            for (const auto& kv : fdb5Element_.key) {
-                key.set(kv.first, kv.second);
-            }
-            dasiElement_.key = std::move(key);
+            assignKey(dasiElement_.key, fdb5Element_.key);
 
             /// @todo write some helpers for policy specification, to reduce boilerplate
             if (policySpecifiers_.empty() || policySpecifiers_[0] == "access") {
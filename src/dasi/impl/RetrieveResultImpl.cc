@@ -1,6 +1,9 @@
 
 #include "dasi/impl/RetrieveResultImpl.h"
+#include "dasi/impl/KeyConversion.h"
+#include "dasi/impl/Metrics.h"
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/io/DataHandle.h"
 #include "fdb5/io/HandleGatherer.h"
 
@@ -10,18 +13,34 @@ namespace dasi {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-RetrieveResultImpl::RetrieveResultImpl(fdb5::ListIterator&& iter) :
-    APIGeneratorImpl<RetrieveElement>() {
-    fdb5::ListElement elem;
-    while (iter.next(elem)) {
-        values_.push_back(elem);
-    }
+RetrieveResultImpl::RetrieveResultImpl(fdb5::ListIterator&& iter, std::shared_ptr<const ObjectEncoder> encoder,
+                                       bool verify, std::shared_ptr<Metrics> metrics) :
+    RetrieveResultImpl(collect(std::move(iter)), std::move(encoder), verify, std::move(metrics)) {}
+
+RetrieveResultImpl::RetrieveResultImpl(std::vector<fdb5::ListElement> values,
+                                       std::shared_ptr<const ObjectEncoder> encoder, bool verify,
+                                       std::shared_ptr<Metrics> metrics) :
+    APIGeneratorImpl<RetrieveElement>(),
+    values_(std::move(values)),
+    encoder_(std::move(encoder)),
+    verify_(verify),
+    decoded_(values_.size()),
+    metrics_(std::move(metrics)) {
 
     // And start the iteration
     iter_ = values_.begin();
     updateResult();
 }
 
+RetrieveResultImpl::vector_type RetrieveResultImpl::collect(fdb5::ListIterator&& iter) {
+    vector_type values;
+    fdb5::ListElement elem;
+    while (iter.next(elem)) {
+        values.push_back(elem);
+    }
+    return values;
+}
+
 void RetrieveResultImpl::next() {
     if (!done_) {
         ++iter_;
@@ -32,13 +51,7 @@ void RetrieveResultImpl::next() {
 void RetrieveResultImpl::updateResult() {
     done_ = (iter_ == values_.end());
     if (!done_) {
-        Key key;
-        for (const auto& subkey : iter_->key()) {
-            for (const auto& kv : subkey) {
-                key.set(kv.first, kv.second);
-            }
-        }
-        dasiElement_.key = std::move(key);
+        assignKey(dasiElement_.key, iter_->key());
         dasiElement_.timestamp = iter_->timestamp();
         dasiElement_.location.uri = iter_->location().uri();
         dasiElement_.location.offset = iter_->location().offset();
@@ -46,6 +59,19 @@ void RetrieveResultImpl::updateResult() {
     }
 }
 
+const StoredObject& RetrieveResultImpl::decoded() const {
+    ASSERT(!done_);
+    auto& decoded = decoded_[iter_ - values_.begin()];
+    if (!decoded) {
+        if (encoder_ && encoder_->encoded(iter_->key()[0])) {
+            decoded = ObjectEncoder::inspect(*iter_);
+        } else {
+            decoded = StoredObject{iter_->location().length(), std::nullopt};
+        }
+    }
+    return *decoded;
+}
+
 const RetrieveElement& RetrieveResultImpl::value() const { return dasiElement_; }
 
 bool RetrieveResultImpl::done() const { return done_; }
@@ -56,10 +82,19 @@ std::unique_ptr<eckit::DataHandle> RetrieveResultImpl::dataHandle() const {
     bool sorted = false;
     fdb5::HandleGatherer result(sorted);
 
-    for (const auto& elem : values_) {
-        result.add(elem.location().dataHandle());
+    for (size_t i = 0; i < values_.size(); ++i) {
+        eckit::DataHandle* dh = values_[i].location().dataHandle();
+        if (encoder_ && encoder_->encoded(values_[i].key()[0])) {
+            // The envelope is read when the handle is opened, so need not be inspected first
+            const eckit::Length length = decoded_[i] ? decoded_[i]->length : eckit::Length(0);
+            dh = new DecodeHandle(dh, length, verify_);
+        }
+        result.add(dh);
     }
 
+    if (metrics_) {
+        return std::make_unique<MeteredHandle>(result.dataHandle(), metrics_);
+    }
     return std::unique_ptr<eckit::DataHandle>{result.dataHandle()};
 }
 
@@ -67,6 +102,14 @@ size_t RetrieveResultImpl::count() const {
     return values_.size();
 }
 
+size_t RetrieveResultImpl::storedLength() const {
+    size_t total = 0;
+    for (const auto& value : values_) {
+        total += value.location().length();
+    }
+    return total;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace dasi
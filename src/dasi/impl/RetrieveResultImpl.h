@@ -7,14 +7,18 @@
 #include "fdb5/api/helpers/ListIterator.h"
 #include "dasi/api/detail/Generators.h"
 #include "dasi/api/detail/RetrieveDetail.h"
+#include "dasi/impl/ObjectEncoding.h"
 
 #include <memory>
+#include <optional>
 
 namespace eckit { class DataHandle; }
 
 
 namespace dasi {
 
+class Metrics;
+
 //----------------------------------------------------------------------------------------------------------------------
 
 class RetrieveResultImpl : public APIGeneratorImpl<RetrieveElement> {
@@ -27,7 +31,18 @@ public:
 
 public: // methods
 
-    explicit RetrieveResultImpl(fdb5::ListIterator&& iter);
+    /// @param encoder Transparently decode the objects in the spaces it encodes. Their envelopes are
+    ///                only read when the data is, or when their decoded length or checksum is asked
+    ///                for. If nullptr, the objects are returned as stored.
+    /// @param verify Check the checksums of the objects as they are read
+    /// @param metrics Record the reads from the data handle, if provided
+    explicit RetrieveResultImpl(fdb5::ListIterator&& iter, std::shared_ptr<const ObjectEncoder> encoder=nullptr,
+                                bool verify=false, std::shared_ptr<Metrics> metrics=nullptr);
+
+    /// Retrieve the elements of an earlier lookup (e.g. held by the catalogue cache)
+    explicit RetrieveResultImpl(std::vector<fdb5::ListElement> values,
+                                std::shared_ptr<const ObjectEncoder> encoder=nullptr, bool verify=false,
+                                std::shared_ptr<Metrics> metrics=nullptr);
 
     // Functions to implement iteration in RetrieveResult
 
@@ -48,8 +63,18 @@ public: // methods
     [[ nodiscard ]]
     size_t count() const;
 
+    /// The decoded length and checksum of the current element. Reads its envelope, if it has one.
+    [[ nodiscard ]]
+    const StoredObject& decoded() const;
+
+    /// The total length of the objects as stored, without reading them
+    [[ nodiscard ]]
+    size_t storedLength() const;
+
 private: // methods
 
+    static vector_type collect(fdb5::ListIterator&& iter);
+
     void updateResult();
 
 private: // members
@@ -57,6 +82,14 @@ private: // members
     /// @todo - use something other than ListElement, such that it can be properly iterated by the user-facing code
     vector_type values_;
 
+    std::shared_ptr<const ObjectEncoder> encoder_;
+    bool verify_;
+
+    /// Filled in as the objects are inspected
+    mutable std::vector<std::optional<StoredObject>> decoded_;
+
+    std::shared_ptr<Metrics> metrics_;
+
     vector_type::const_iterator iter_;
     dasi::ListElement dasiElement_;
     bool done_;
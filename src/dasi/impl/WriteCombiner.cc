@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#include "dasi/impl/WriteCombiner.h"
+
+#include "dasi/impl/DirectStore.h"
+
+#include "fdb5/database/FieldLocation.h"
+#include "fdb5/database/Store.h"
+#include "fdb5/rules/Schema.h"
+
+#include "eckit/exception/Exceptions.h"
+
+namespace dasi {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+WriteCombiner::WriteCombiner(const fdb5::Config& config, size_t objectBytes, size_t bufferBytes, Indexer&& indexer) :
+    config_(config),
+    databases_(config_.schema()),
+    objectBytes_(objectBytes),
+    bufferBytes_(bufferBytes),
+    indexer_(std::move(indexer)) {
+
+    if (objectBytes_ > bufferBytes_) {
+        throw eckit::UserError("archive.combine.object_bytes must not be larger than buffer_bytes", Here());
+    }
+}
+
+WriteCombiner::~WriteCombiner() = default;
+
+void WriteCombiner::stage(const fdb5::Key& key, const void* data, size_t length) {
+
+    ASSERT(accepts(length));
+    ASSERT(!full(length));
+
+    const fdb5::Key dbKey = databases_.database(key);
+
+    Stage& stage = stages_[dbKey];
+    const auto* bytes = static_cast<const char*>(data);
+    stage.objects.push_back(Object{key, stage.data.size(), length});
+    stage.data.insert(stage.data.end(), bytes, bytes + length);
+
+    keys_.insert(key);
+    stagedBytes_ += length;
+}
+
+void WriteCombiner::drain() {
+
+    while (!stages_.empty()) {
+        auto it = stages_.begin();
+        const fdb5::Key& dbKey = it->first;
+        Stage& stage = it->second;
+
+        // One append for all of the objects of the database
+        auto store = openStore(config_, dbKey);
+        std::unique_ptr<fdb5::FieldLocation> location(store->archive(dbKey, stage.data.data(), stage.data.size()));
+        store->flush();
+        store->close();
+
+        for (const auto& object : stage.objects) {
+            indexer_(object.key, *partOf(*location, object.offset, object.length));
+        }
+
+        for (const auto& object : stage.objects) { keys_.erase(object.key); }
+        stagedBytes_ -= stage.data.size();
+        stages_.erase(it);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi
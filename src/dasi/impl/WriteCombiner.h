@@ -0,0 +1,113 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/// @date   Oct 2023
+
+#pragma once
+
+#include "dasi/impl/DatabaseKeys.h"
+
+#include "fdb5/config/Config.h"
+#include "fdb5/database/Key.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace fdb5 { class FieldLocation; }
+
+namespace dasi {
+
+//-------------------------------------------------------------------------------------------------
+
+/// Gathers small objects, and writes those of each database to its store in one append. Each object
+/// is then indexed individually, to its own part of the append, so many small objects cost one
+/// write rather than one each.
+///
+/// Objects are copied into a staging area until it is full, or until drained (on flush). They are
+/// not visible until they have been drained and the FDB flushed. Objects are indexed in the order
+/// they were staged, so the latest object with a key is the one found.
+
+class WriteCombiner {
+
+public: // types
+
+    /// Indexes a combined object, at its part of the append
+    using Indexer = std::function<void(const fdb5::Key&, const fdb5::FieldLocation&)>;
+
+public: // methods
+
+    /// @param objectBytes The largest object that is combined
+    /// @param bufferBytes The size of the staging area, across all databases
+    WriteCombiner(const fdb5::Config& config, size_t objectBytes, size_t bufferBytes, Indexer&& indexer);
+    ~WriteCombiner();
+
+    /// Is the object small enough to be combined?
+    [[ nodiscard ]]
+    bool accepts(size_t length) const { return length > 0 && length <= objectBytes_; }
+
+    /// Is there no room left in the staging area for the object?
+    [[ nodiscard ]]
+    bool full(size_t length) const { return stagedBytes_ + length > bufferBytes_; }
+
+    /// Is there an object with this key waiting to be written?
+    [[ nodiscard ]]
+    bool staged(const fdb5::Key& key) const { return keys_.find(key) != keys_.end(); }
+
+    [[ nodiscard ]]
+    bool empty() const { return stages_.empty(); }
+
+    /// Copy the object into the staging area, which must have room for it
+    void stage(const fdb5::Key& key, const void* data, size_t length);
+
+    /// Write out and index all of the staged objects. The objects of a database that fails to be
+    /// written are kept, to be written by the next drain.
+    void drain();
+
+private: // types
+
+    struct Object {
+        fdb5::Key key;
+        size_t offset;
+        size_t length;
+    };
+
+    /// The objects staged for a database
+    struct Stage {
+        std::vector<char> data;
+        std::vector<Object> objects;
+    };
+
+private: // members
+
+    const fdb5::Config config_;
+    const DatabaseKeys databases_;
+
+    const size_t objectBytes_;
+    const size_t bufferBytes_;
+
+    std::map<fdb5::Key, Stage> stages_;
+    std::set<fdb5::Key> keys_;
+    size_t stagedBytes_ = 0;
+
+    Indexer indexer_;
+};
+
+//-------------------------------------------------------------------------------------------------
+
+} // namespace dasi
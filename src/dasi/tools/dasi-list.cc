@@ -1,5 +1,6 @@
 #include "eckit/option/CmdArgs.h"
 #include "eckit/option/SimpleOption.h"
+#include "eckit/exception/Exceptions.h"
 #include "eckit/log/Log.h"
 
 #include "dasi/tools/DASITool.h"
@@ -17,8 +18,15 @@ public: // methods
 
     DASIList(int argc, char **argv) :
         DASITool(argc, argv),
-        location_(false) {
+        location_(false),
+        since_(0),
+        limit_(0) {
         options_.push_back(new SimpleOption<bool>("location", "Also print the location of each field"));
+        options_.push_back(new SimpleOption<long>("since", "Only list the fields archived at or after this time "
+                                                           "(seconds since the epoch)"));
+        options_.push_back(new SimpleOption<long>("limit", "List at most this many fields, and print the cursor "
+                                                           "from which to continue"));
+        options_.push_back(new SimpleOption<std::string>("cursor", "Continue a listing from a printed cursor"));
     }
 
 private: // methods
@@ -28,6 +36,9 @@ private: // methods
     void execute(const eckit::option::CmdArgs& args) override;
 
     bool location_;
+    long since_;
+    long limit_;
+    std::string cursor_;
 };
 
 void DASIList::usage(const std::string &tool) const {
@@ -45,6 +56,13 @@ void DASIList::usage(const std::string &tool) const {
 
 void DASIList::init(const eckit::option::CmdArgs &args) {
     location_ = args.getBool("location", location_);
+    since_ = args.getLong("since", since_);
+    limit_ = args.getLong("limit", limit_);
+    cursor_ = args.getString("cursor", cursor_);
+    if (limit_ < 0) { throw eckit::UserError("--limit must not be negative", Here()); }
+    if (!cursor_.empty() && args.count() > 1) {
+        throw eckit::UserError("--cursor continues the listing of a single query", Here());
+    }
 }
 
 void DASIList::execute(const eckit::option::CmdArgs& args) {
@@ -52,10 +70,20 @@ void DASIList::execute(const eckit::option::CmdArgs& args) {
     for (size_t i = 0; i < args.count(); ++i) {
 
         dasi::Query q(args(i));
-        for (const auto& elem : dasi().list(q)) {
+        ListOptions options;
+        // Only the keys are printed, unless the locations are asked for too
+        options.fields = location_ ? ListFields::Full : ListFields::Keys;
+        options.since = since_;
+        options.limit = limit_;
+        options.cursor = cursor_;
+        auto list = dasi().list(q, options);
+        for (const auto& elem : list) {
             elem.print(eckit::Log::info(), location_);
             eckit::Log::info() << eckit::newl;
         }
+        if (options.limit > 0 || !options.cursor.empty()) {
+            eckit::Log::info() << "cursor=" << list.cursor() << std::endl;
+        }
     }
 }
 
@@ -1,7 +1,6 @@
 #include "eckit/exception/Exceptions.h"
 #include "eckit/log/Log.h"
-#include "eckit/io/Buffer.h"
-#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/DataHandle.h"
 #include "eckit/option/CmdArgs.h"
 #include "eckit/option/SimpleOption.h"
 
@@ -53,10 +52,7 @@ void DASIPut::execute(const eckit::option::CmdArgs& args) {
         eckit::PathName path(args(2*i+1));
 
         std::unique_ptr<DataHandle> dh(path.fileHandle());
-        MemoryHandle mh;
-        dh->copyTo(mh);
-
-        dasi().archive(k, mh.data(), mh.size());
+        dasi().archive(k, *dh);
     }
 }
 
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/testing/Test.h"
+
+#include "dasi/api/Key.h"
+#include "dasi/api/Query.h"
+#include "dasi/impl/KeyConversion.h"
+
+#include "fdb5/database/Key.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Count the heap allocations made by the code under test
+
+namespace {
+std::atomic<size_t> allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+template <typename F>
+size_t countAllocations(F&& f) {
+    const size_t before = allocations.load();
+    f();
+    return allocations.load() - before;
+}
+
+const std::vector<std::string> keywords {"class", "stream", "expver", "date", "time", "type", "levtype", "param"};
+
+}  // namespace
+
+CASE("Converting listed keys in place does not allocate") {
+
+    // Keys as an FDB listing gives them, split into database, index and datum parts: the same
+    // keywords, different values
+    std::vector<std::vector<fdb5::Key>> elements;
+    for (size_t i = 0; i < 1000; ++i) {
+        std::vector<fdb5::Key> parts(3);
+        for (size_t k = 0; k < keywords.size(); ++k) {
+            parts[k * parts.size() / keywords.size()].set(keywords[k], keywords[k] + std::to_string(i));
+        }
+        elements.push_back(std::move(parts));
+    }
+
+    Key key;
+    assignKey(key, elements[0]);
+
+    const size_t n = countAllocations([&] {
+        for (const auto& parts : elements) { assignKey(key, parts); }
+    });
+
+    EXPECT(n == 0);
+    EXPECT(key.size() == keywords.size());
+    EXPECT(key.get("param") == "param999");
+}
+
+CASE("Moving values into a key does not copy them") {
+
+    Key key {{"keyword", "value"}};
+    const std::string longValue(1024, 'x');
+
+    std::string moved = longValue;
+    EXPECT(countAllocations([&] { key.set(std::string("keyword"), std::move(moved)); }) == 0);
+    EXPECT(key.get("keyword") == longValue);
+
+    // The value is only constructed if the keyword is missing
+    EXPECT(countAllocations([&] { EXPECT(!key.try_emplace("keyword", 1024, 'y').second); }) == 0);
+    EXPECT(key.get("keyword") == longValue);
+
+    auto result = key.try_emplace("other", 3, 'z');
+    EXPECT(result.second);
+    EXPECT(key.get("other") == "zzz");
+}
+
+CASE("Moving values into a query does not copy them") {
+
+    Query query {{"keyword", {"value"}}};
+
+    std::vector<std::string> values(100, std::string(1024, 'x'));
+    EXPECT(countAllocations([&] { query.set(std::string("keyword"), std::move(values)); }) == 0);
+    EXPECT(query.get("keyword").size() == 100);
+
+    EXPECT(countAllocations([&] { EXPECT(!query.try_emplace("keyword", 10, "y").second); }) == 0);
+    EXPECT(query.try_emplace("other", 2, "z").second);
+    EXPECT(query.get("other").size() == 2);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
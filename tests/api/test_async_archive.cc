@@ -0,0 +1,293 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/io/MemoryHandle.h"
+
+#include "dasi/api/Dasi.h"
+
+#include "helper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Asynchronous archive") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    // A tiny queue limit, such that backpressure is exercised
+    constexpr const char* appConfig = "archive:\n"
+                                      "  async: true\n"
+                                      "  queue_bytes: 64\n";
+
+    dasi::Dasi dasi(cfg.c_str(), appConfig);
+
+    const auto keys = KeySet({"value3b1", "value3b2", "value3b3", "value3b4"});
+
+    for (auto&& key : keys) {
+        std::string data = "DASI ASYNC ARCHIVE TEST DATA " + key.get("key3b");
+        dasi.archive(key, data.data(), data.size());
+        // The caller's buffer may be reused as soon as archive() returns
+        std::fill(data.begin(), data.end(), 'x');
+    }
+
+    dasi.flush();
+
+    SECTION("list all") {
+        dasi::Query query {{"key1", {"value1"}}, {"key2", {"value2"}}, {"key3", {"value3"}}};
+        auto list = dasi.list(query);
+        EXPECT(keys.lookup(list) == keys.size());
+    }
+
+    SECTION("retrieve one") {
+        dasi::Query query {{"key1", {"value1"}},   {"key2", {"value2"}},   {"key3", {"value3"}},
+                           {"key1a", {"value1a"}}, {"key2a", {"value2a"}}, {"key3a", {"value3a"}},
+                           {"key1b", {"value1b"}}, {"key2b", {"value2b"}}, {"key3b", {"value3b2"}}};
+
+        auto ret = dasi.retrieve(query);
+        EXPECT(ret.count() == 1);
+
+        eckit::MemoryHandle mh;
+        ret.dataHandle()->saveInto(mh);
+
+        const std::string ref = "DASI ASYNC ARCHIVE TEST DATA value3b2";
+        EXPECT(mh.size() == ref.size());
+        EXPECT(memcmp(mh.data(), ref.data(), ref.size()) == 0);
+    }
+}
+
+CASE("Asynchronous archive sharded across databases") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str(), "archive:\n  async: true\n  writers: 3\n");
+
+    // Five databases (first-level keys), spread across three writers
+
+    const std::vector<std::string> databases {"db1", "db2", "db3", "db4", "db5"};
+
+    for (const auto& db : databases) {
+        for (auto key : KeySet({"value3b1", "value3b2", "value3b3"})) {
+            key.set("key1", db);
+            const std::string data = "DASI SHARDED ARCHIVE TEST DATA " + db;
+            dasi.archive(key, data.data(), data.size());
+        }
+    }
+
+    dasi.flush();
+
+    for (const auto& db : databases) {
+        dasi::Query query {{"key1", {db}}, {"key2", {"value2"}}, {"key3", {"value3"}}};
+        size_t count = 0;
+        for (const auto& elem : dasi.list(query)) {
+            EXPECT(elem.key.get("key1") == db);
+            ++count;
+        }
+        EXPECT(count == 3);
+    }
+}
+
+CASE("Archive with ownership transfer") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    for (const char* appConfig : {"archive:\n  async: false\n", "archive:\n  async: true\n"}) {
+
+        dasi::Dasi dasi(cfg.c_str(), appConfig);
+
+        const auto keys = KeySet({"value3b1", "value3b2"});
+
+        const std::string ref = "DASI OWNED ARCHIVE TEST DATA";
+
+        auto buffer = std::make_unique<eckit::Buffer>(ref.size());
+        ::memcpy(buffer->data(), ref.data(), ref.size());
+        dasi.archive(*keys.begin(), std::move(buffer));
+
+        int released = 0;
+        auto* raw = new std::string(ref);
+        dasi.archive(*keys.rbegin(), raw->data(), raw->size(), [raw, &released] {
+            delete raw;
+            ++released;
+        });
+
+        dasi.flush();
+        EXPECT(released == 1);
+
+        dasi::Query query {{"key1", {"value1"}}, {"key2", {"value2"}}, {"key3", {"value3"}}};
+        auto list = dasi.list(query);
+        EXPECT(keys.lookup(list) == keys.size());
+
+        auto ret = dasi.retrieve({{"key1", {"value1"}},   {"key2", {"value2"}},   {"key3", {"value3"}},
+                                  {"key1a", {"value1a"}}, {"key2a", {"value2a"}}, {"key3a", {"value3a"}},
+                                  {"key1b", {"value1b"}}, {"key2b", {"value2b"}}, {"key3b", {"value3b1", "value3b2"}}});
+        eckit::MemoryHandle mh;
+        EXPECT(ret.dataHandle()->saveInto(mh) == eckit::Length(2 * ref.size()));
+    }
+}
+
+CASE("Write combining of small objects") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    for (const char* async : {"false", "true"}) {
+
+        std::ostringstream appConfig;
+        appConfig << "archive:\n"
+                     "  async: " << async << "\n"
+                     "  combine:\n"
+                     "    object_bytes: 16\n"
+                     "    buffer_bytes: 64\n";
+
+        dasi::Dasi dasi(cfg.c_str(), appConfig.str().c_str());
+
+        const auto keys = KeySet({"small1", "small2", "small3", "small4", "small5", "large"});
+
+        for (auto&& key : keys) {
+            const std::string data = (key.get("key3b") == "large") ? std::string(100, 'L') : key.get("key3b");
+            dasi.archive(key, data.data(), data.size());
+        }
+
+        // A large object overwriting a staged small one must win
+        const auto overwritten = *KeySet({"small1"}).begin();
+        const std::string replacement(32, 'R');
+        dasi.archive(overwritten, replacement.data(), replacement.size());
+
+        dasi.flush();
+
+        dasi::Query query {{"key1", {"value1"}}, {"key2", {"value2"}}, {"key3", {"value3"}}};
+        auto list = dasi.list(query);
+        EXPECT(keys.lookup(list) == keys.size());
+
+        // The remaining small objects were written in one append, and each is indexed to its part of it
+        std::vector<std::pair<long long, long long>> parts;
+        std::string uri;
+        for (const auto& elem : dasi.list(query, ListOptions{ListFields::Locations})) {
+            const auto& value = elem.key.get("key3b");
+            if (value == "large" || value == "small1") continue;
+            if (uri.empty()) { uri = elem.location.uri.asString(); }
+            EXPECT(elem.location.uri.asString() == uri);
+            EXPECT(elem.location.length == eckit::Length(value.size()));
+            parts.emplace_back(elem.location.offset, elem.location.length);
+        }
+        EXPECT(parts.size() == 4);
+        std::sort(parts.begin(), parts.end());
+        for (size_t i = 1; i < parts.size(); ++i) {
+            EXPECT(parts[i].first == parts[i - 1].first + parts[i - 1].second);
+        }
+
+        for (auto&& key : keys) {
+            dasi::Query one;
+            for (const auto& kv : key) { one.set(kv.first, {kv.second}); }
+            const auto& value = key.get("key3b");
+            const std::string expected =
+                    (value == "small1") ? replacement : (value == "large") ? std::string(100, 'L') : value;
+            eckit::MemoryHandle mh;
+            dasi.retrieve(one).dataHandle()->saveInto(mh);
+            EXPECT(mh.size() == expected.size());
+            EXPECT(memcmp(mh.data(), expected.data(), expected.size()) == 0);
+        }
+    }
+}
+
+CASE("Automatic flush") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    const std::string data = "DASI AUTOMATIC FLUSH TEST DATA";
+
+    // Counts what is visible to another session, i.e. what has been flushed
+    auto flushedCount = [&cfg](const KeySet& keys) {
+        dasi::Dasi reader(cfg.c_str());
+        dasi::Query query {{"key1", {"value1"}}, {"key2", {"value2"}}, {"key3", {"value3"}}};
+        auto list = reader.list(query);
+        return keys.lookup(list);
+    };
+
+    SECTION("Flush after a number of objects") {
+        dasi::Dasi dasi(cfg.c_str(), "flush:\n  max_objects: 3\n");
+        const auto keys = KeySet({"obj1", "obj2", "obj3"});
+        for (auto&& key : keys) { dasi.archive(key, data.data(), data.size()); }
+        EXPECT(flushedCount(keys) == keys.size());
+    }
+
+    SECTION("Flush after a number of bytes") {
+        std::ostringstream appConfig;
+        appConfig << "flush:\n  max_bytes: " << 2 * data.size() << "\n";
+        dasi::Dasi dasi(cfg.c_str(), appConfig.str().c_str());
+        const auto keys = KeySet({"obj1", "obj2"});
+        for (auto&& key : keys) { dasi.archive(key, data.data(), data.size()); }
+        EXPECT(flushedCount(keys) == keys.size());
+    }
+
+    SECTION("Flush after an interval") {
+        dasi::Dasi dasi(cfg.c_str(), "flush:\n  max_interval_ms: 50\n");
+        const auto keys = KeySet({"obj1"});
+        for (auto&& key : keys) { dasi.archive(key, data.data(), data.size()); }
+
+        size_t count = 0;
+        for (int i = 0; i < 100 && count == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            count = flushedCount(keys);
+        }
+        EXPECT(count == keys.size());
+    }
+}
+
+CASE("Asynchronous archive errors are reported") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str(), "archive:\n  async: true\n");
+
+    // Not a valid key for the schema, so the background write fails
+    const dasi::Key key {{"key1", "value1"}};
+    const std::string data = "DATA";
+    dasi.archive(key, data.data(), data.size());
+
+    EXPECT_THROWS(dasi.flush());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/testing/Test.h"
+
+#include "dasi/impl/Crc32c.h"
+
+#include <vector>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Bit at a time, to check the table and hardware implementations against
+uint32_t referenceCrc32c(const unsigned char* data, size_t length) {
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) { crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1))); }
+    }
+    return ~crc;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("CRC-32C known values") {
+
+    EXPECT(crc32c(0, "", 0) == 0);
+    EXPECT(crc32c(0, "123456789", 9) == 0xe3069283);
+
+    // From RFC 3720, appendix B.4
+    std::vector<unsigned char> data(32, 0);
+    EXPECT(crc32c(0, data.data(), data.size()) == 0x8a9136aa);
+
+    data.assign(32, 0xff);
+    EXPECT(crc32c(0, data.data(), data.size()) == 0x62a8ab43);
+
+    for (size_t i = 0; i < data.size(); ++i) { data[i] = static_cast<unsigned char>(i); }
+    EXPECT(crc32c(0, data.data(), data.size()) == 0x46dd794e);
+}
+
+CASE("CRC-32C at any alignment and length") {
+
+    std::vector<unsigned char> data(300);
+    for (size_t i = 0; i < data.size(); ++i) { data[i] = static_cast<unsigned char>(i * 31 + 7); }
+
+    for (size_t start = 0; start < 8; ++start) {
+        for (size_t length = 0; start + length <= data.size(); length += 13) {
+            EXPECT(crc32c(0, &data[start], length) == referenceCrc32c(&data[start], length));
+        }
+    }
+}
+
+CASE("CRC-32C can be extended incrementally") {
+
+    std::vector<unsigned char> data(1000);
+    for (size_t i = 0; i < data.size(); ++i) { data[i] = static_cast<unsigned char>(i * 17 + 3); }
+
+    const uint32_t whole = crc32c(0, data.data(), data.size());
+
+    for (size_t split = 0; split <= data.size(); split += 37) {
+        const uint32_t first = crc32c(0, data.data(), split);
+        EXPECT(crc32c(first, data.data() + split, data.size() - split) == whole);
+    }
+
+    uint32_t crc = 0;
+    for (const auto byte : data) { crc = crc32c(crc, &byte, 1); }
+    EXPECT(crc == whole);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
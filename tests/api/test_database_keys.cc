@@ -0,0 +1,121 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dasi/impl/DatabaseKeys.h"
+
+#include "fdb5/rules/Schema.h"
+
+#include "helper.h"
+
+#include <string>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// The rule, and so the keywords of the database, depends on the value of key1
+constexpr const char LEVELS_SCHEMA[] = "[ key1=special, key2\n"
+                                       "  [ key1a\n"
+                                       "    [ key1b ]]]\n"
+                                       "[ key1, key2, key3\n"
+                                       "  [ key1a\n"
+                                       "    [ key1b ]]]\n";
+
+fdb5::Key makeKey(const std::string& key1, const std::string& key3, const std::string& key1b) {
+    fdb5::Key key;
+    key.set("key1", key1);
+    key.set("key2", "value2");
+    key.set("key3", key3);
+    key.set("key1a", "value1a");
+    key.set("key1b", key1b);
+    return key;
+}
+
+fdb5::Key expandFirstLevel(const fdb5::Schema& schema, const fdb5::Key& key) {
+    fdb5::Key dbKey;
+    EXPECT(schema.expandFirstLevel(key, dbKey));
+    return dbKey;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Database keys") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "levels_schema", LEVELS_SCHEMA);
+
+    const fdb5::Schema schema((tempDir / "levels_schema").string());
+
+    DatabaseKeys databases(schema);
+    EXPECT(databases.remembering());
+
+    SECTION("same databases as matching the schema, in any order") {
+        // Twice over, so that the second pass finds the remembered databases
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const char* key1b : {"0", "1", "2"}) {
+                for (const char* key1 : {"special", "value1", "value1x"}) {
+                    for (const char* key3 : {"a", "b"}) {
+                        const auto key = makeKey(key1, key3, key1b);
+                        EXPECT(databases.database(key) == expandFirstLevel(schema, key));
+                    }
+                }
+            }
+        }
+        EXPECT(databases.remembering());
+    }
+
+    SECTION("the database is chosen by value") {
+        const auto special = databases.database(makeKey("special", "a", "0"));
+        EXPECT(special.find("key3") == special.end());
+
+        const auto other = databases.database(makeKey("value1", "a", "0"));
+        EXPECT(other.find("key3") != other.end());
+
+        EXPECT(databases.database(makeKey("special", "b", "1")) == special);
+    }
+
+    SECTION("more databases than are remembered") {
+        DatabaseKeys few(schema, 2);
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const char* key3 : {"a", "b", "c", "d", "e"}) {
+                const auto key = makeKey("value1", key3, "0");
+                EXPECT(few.database(key) == expandFirstLevel(schema, key));
+            }
+        }
+    }
+
+    SECTION("keys that match no rule") {
+        fdb5::Key key;
+        key.set("key1", "value1");
+        key.set("key2", "value2");
+        EXPECT_THROWS_AS(databases.database(key), eckit::UserError);
+
+        // and the same key is not remembered as matching
+        EXPECT_THROWS_AS(databases.database(key), eckit::UserError);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -15,6 +15,7 @@
 
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 using namespace std::string_literals;
 
@@ -88,6 +89,29 @@ CASE("Construct from string") {
 CASE("Rejects invalid keys") {
     EXPECT_THROWS_AS(dasi::Key("key3=value3=value3b,key1=value1,key2=value2"), eckit::UserError);
     EXPECT_THROWS_AS(dasi::Key("key3=value3/value3b,key1=value1,key2=value2"), eckit::UserError);
+    EXPECT_THROWS_AS(dasi::Key("key1"), eckit::UserError);
+    EXPECT_THROWS_AS(dasi::Key("=value1"), eckit::UserError);
+    EXPECT_THROWS_AS(dasi::Key("key1="), eckit::UserError);
+    EXPECT_THROWS_AS(dasi::Key("key1='value1"), eckit::UserError);
+    EXPECT_THROWS_AS(dasi::Key("key1=value1\\"), eckit::UserError);
+
+    try {
+        dasi::Key("key1=value1,key2=value2=x");
+        EXPECT(false);
+    } catch (const eckit::UserError& e) {
+        EXPECT(std::string(e.what()).find("at position 23") != std::string::npos);
+    }
+}
+
+CASE("Construct from string with quoting and escaping") {
+
+    dasi::Key k(R"(key1=a\,b,key2='c=d/e',key3="say \"hi\"",key4='',,)");
+
+    EXPECT(k.size() == 4);
+    EXPECT(k.get("key1") == "a,b");
+    EXPECT(k.get("key2") == "c=d/e");
+    EXPECT(k.get("key3") == "say \"hi\"");
+    EXPECT(k.get("key4") == "");
 }
 
 CASE("Modify existing key") {
@@ -116,6 +140,36 @@ CASE("Modify existing key") {
     EXPECT(k.size() == 3);
 }
 
+CASE("Iterate as a map") {
+
+    dasi::Key k {
+        {"key2", "value2"},
+        {"key1", "value1"},
+    };
+
+    // Elements are presented as the pairs of strings of the map the key used to be
+    std::string joined;
+    for (const auto& kv : k) {
+        const std::string& keyword = kv.first;
+        joined += keyword + "=" + kv.second + ";";
+    }
+    EXPECT(joined == "key1=value1;key2=value2;");
+
+    const dasi::Key::map_type map(k.begin(), k.end());
+    EXPECT(map.size() == 2);
+    EXPECT(map.at("key2") == "value2");
+
+    // The iterators returned by set() are read-only, so cannot unsort the key or stale its hash
+    auto it = k.set("key0", "value0");
+    EXPECT(it->first == "key0");
+    EXPECT(it->second == "value0");
+    EXPECT(it == k.begin());
+
+    auto emplaced = k.try_emplace("key0", "other");
+    EXPECT(!emplaced.second);
+    EXPECT(emplaced.first->second == "value0");
+}
+
 CASE("Test that clear() works") {
 
     dasi::Key k {
@@ -139,6 +193,34 @@ CASE("Test that clear() works") {
     EXPECT(k.size() == 3);
 }
 
+CASE("Hashing") {
+
+    dasi::Key k1 {{"key1", "value1"}, {"key2", "value2"}};
+
+    dasi::Key k2;
+    k2.set("key2", "value2");
+    k2.set("key1", "value1");
+
+    // Independent of insertion order, and stable across processes and platforms (FNV-1a)
+    EXPECT(k1.hash() == k2.hash());
+    const dasi::Key reference {{"key1", "value1"}};
+    EXPECT(reference.hash() == 0x96cc29b456481a53ULL);
+
+    const auto h = k1.hash();
+    k1.set("key1", "VALUE1");
+    EXPECT(k1.hash() != h);
+    k1.set("key1", "value1");
+    EXPECT(k1.hash() == h);
+    k1.erase("key2");
+    EXPECT(k1.hash() != h);
+
+    std::unordered_map<dasi::Key, int> map;
+    map[k2] = 1;
+    map[dasi::Key{{"key1", "value1"}, {"key2", "value2"}}] = 2;
+    EXPECT(map.size() == 1);
+    EXPECT(map[k2] == 2);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 int main(int argc, char** argv) {
@@ -4,6 +4,7 @@
 
 #include <sstream>
 #include <string>
+#include <unordered_set>
 
 using namespace std::string_literals;
 
@@ -161,6 +162,73 @@ CASE("Modify existing query") {
     }
 }
 
+CASE("Construct from string with quoting and escaping") {
+
+    dasi::Query r(R"(date='2023/01/01'/2023\/01\/02,key1=value1)");
+
+    EXPECT(r.get("date").size() == 2);
+    EXPECT(r.get("date")[0] == "2023/01/01");
+    EXPECT(r.get("date")[1] == "2023/01/02");
+    EXPECT(r.get("key1").size() == 1);
+
+    EXPECT_THROWS_AS(dasi::Query("key1=value1//value2"), eckit::UserError);
+    EXPECT_THROWS_AS(dasi::Query("key1=value1=value2"), eckit::UserError);
+    EXPECT_THROWS_AS(dasi::Query("key1"), eckit::UserError);
+}
+
+CASE("Range expansion") {
+
+    dasi::Query r("step=0/to/24/by/6,level=1/2/10/to/12,date=20240228/to/20240301,number=all,param=t");
+
+    auto join = [](const dasi::QueryValues& values) {
+        std::string s;
+        for (const auto& v : values) { s += (s.empty() ? "" : "/") + v; }
+        return s;
+    };
+
+    EXPECT(r.expanded("step").hasRanges());
+    EXPECT(r.expanded("step").size() == 5);
+    EXPECT(join(r.expanded("step")) == "0/6/12/18/24");
+    EXPECT(join(r.expanded("level")) == "1/2/10/11/12");
+    EXPECT(join(r.expanded("date")) == "20240228/20240229/20240301");
+    EXPECT(r.expanded("number").all());
+    EXPECT(!r.expanded("param").hasRanges());
+    EXPECT(join(r.expanded("param")) == "t");
+
+    // The values are stored as given
+    EXPECT(r.get("step").size() == 5);
+
+    dasi::Query bad("step=0/to/x,level=10/to/1,number=1/to");
+    EXPECT_THROWS_AS(bad.expanded("step"), eckit::UserError);
+    EXPECT_THROWS_AS(bad.expanded("level"), eckit::UserError);
+    EXPECT_THROWS_AS(bad.expanded("number"), eckit::UserError);
+}
+
+CASE("Hashing") {
+
+    dasi::Query q1 {{"key1", {"value1", "value2"}}, {"key2", {"value3"}}};
+
+    dasi::Query q2;
+    q2.append("key2", "value3");
+    q2.append("key1", "value1");
+    q2.append("key1", "value2");
+
+    EXPECT(q1 == q2);
+    EXPECT(q1.hash() == q2.hash());
+
+    // The grouping of values matters
+    dasi::Query q3 {{"key1", {"value1"}}, {"key2", {"value2", "value3"}}};
+    EXPECT(q1 != q3);
+    EXPECT(q1.hash() != q3.hash());
+
+    const auto h = q1.hash();
+    q1.append("key2", "value4");
+    EXPECT(q1.hash() != h);
+
+    std::unordered_set<dasi::Query> set {q1, q2, q3};
+    EXPECT(set.size() == 3);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 int main(int argc, char** argv) {
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/testing/Test.h"
+
+#include "dasi/api/Serialisation.h"
+
+#include <string>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Key round trip") {
+
+    const Key key{{"class", "od"}, {"expver", "0001"}, {"param", "130"}, {"empty", ""}};
+    const std::string data = encode(key);
+    EXPECT(decodeKey(data) == key);
+
+    EXPECT(decodeKey(encode(Key{})).size() == 0);
+}
+
+CASE("Query round trip") {
+
+    const Query query{{"class", {"od"}}, {"param", {"130", "131", "132"}}, {"step", {"0/to/12/by/6"}}};
+    EXPECT(decodeQuery(encode(query)) == query);
+}
+
+CASE("ListElement round trip") {
+
+    ListElement element;
+    element.key = Key{{"class", "od"}, {"param", "130"}};
+    element.location.uri = eckit::URI("file:///data/od/0001.data");
+    element.location.offset = 1234567;
+    element.location.length = 8192;
+    element.timestamp = 1696156800;
+
+    for (bool withChecksum : {false, true}) {
+        if (withChecksum) element.checksum = 0xdeadbeef;
+        ListElement decoded = decodeListElement(encode(element));
+        EXPECT(decoded.key == element.key);
+        EXPECT(decoded.location.uri.asString() == element.location.uri.asString());
+        EXPECT(decoded.location.offset == element.location.offset);
+        EXPECT(decoded.location.length == element.location.length);
+        EXPECT(decoded.timestamp == element.timestamp);
+        EXPECT(decoded.checksum == element.checksum);
+    }
+}
+
+CASE("Keywords are written once per stream") {
+
+    Encoder encoder;
+    Key key{{"class", "od"}, {"expver", "0001"}, {"param", "0"}};
+    encoder.encode(key);
+    const size_t first = encoder.buffer().size();
+
+    for (int i = 1; i < 10; ++i) {
+        key.set("param", std::to_string(i));
+        encoder.encode(key);
+    }
+
+    // After the first record, each is a type, a count, and three (reference, length, value)
+    EXPECT(encoder.buffer().size() - first == 9 * (1 + 1 + 3 * 2 + (2 + 4 + 1)));
+
+    Decoder decoder(encoder.buffer().data(), encoder.buffer().size());
+    Key decoded;
+    for (int i = 0; i < 10; ++i) {
+        EXPECT(!decoder.done());
+        decoder.decode(decoded);
+        EXPECT(decoded.get("param") == std::to_string(i));
+        EXPECT(decoded.get("class") == "od");
+    }
+    EXPECT(decoder.done());
+
+    encoder.clear();
+    encoder.encode(key);
+    EXPECT(encoder.buffer().size() == first);
+}
+
+CASE("Invalid data is rejected") {
+
+    const std::string data = encode(Key{{"class", "od"}, {"param", "130"}});
+
+    // Every truncation is detected
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_THROWS_AS((void)decodeKey(data.substr(0, i)), eckit::UserError);
+    }
+
+    EXPECT_THROWS_AS((void)decodeKey(data + "x"), eckit::UserError);
+    EXPECT_THROWS_AS((void)decodeQuery(data), eckit::UserError);
+    EXPECT_THROWS_AS((void)decodeKey("class=od"), eckit::UserError);
+
+    std::string badVersion = data;
+    badVersion[1] = 2;
+    EXPECT_THROWS_AS((void)decodeKey(badVersion), eckit::UserError);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
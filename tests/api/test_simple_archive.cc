@@ -15,11 +15,24 @@
  */
 
 #include "eckit/io/MemoryHandle.h"
+#include "eckit/io/PartFileHandle.h"
+#include "eckit/utils/Compressor.h"
 
 #include "dasi/api/Dasi.h"
+#include "dasi/impl/Crc32c.h"
+#include "dasi/impl/Metrics.h"
+#include "dasi/impl/ObjectEncoding.h"
 
 #include "helper.h"
 
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
 namespace dasi::testing {
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -38,6 +51,568 @@ CASE("Archive data") {
         const std::string data = "DASI SIMPLE ARCHIVE TEST DATA";
         dasi.archive(key, data.data(), data.size());
     }
+
+    SECTION("batch archive") {
+        const auto keys = KeySet({"value3b1", "value3b2", "value3b3"});
+
+        std::vector<const Key*> keyPtrs;
+        std::vector<std::string> data;
+        for (auto&& key : keys) {
+            keyPtrs.push_back(&key);
+            data.push_back("DASI BATCH ARCHIVE TEST DATA " + key.get("key3b"));
+        }
+
+        std::vector<const void*> dataPtrs;
+        std::vector<size_t> lengths;
+        for (const auto& d : data) {
+            dataPtrs.push_back(d.data());
+            lengths.push_back(d.size());
+        }
+
+        dasi.archiveBatch(keyPtrs.data(), dataPtrs.data(), lengths.data(), keyPtrs.size());
+        dasi.flush();
+
+        dasi::Query query {{"key1", {"value1"}}, {"key2", {"value2"}}, {"key3", {"value3"}}};
+        auto list = dasi.list(query);
+        EXPECT(keys.lookup(list) == keys.size());
+    }
+
+    SECTION("batch archive with the databases interleaved") {
+        std::vector<Key> keys;
+        std::vector<std::string> data;
+        for (const char* key3b : {"value3b1", "value3b2", "value3b3"}) {
+            for (const char* key1 : {"value1", "value1x"}) {
+                auto key = *KeySet({key3b}).begin();
+                key.set("key1", key1);
+                keys.push_back(key);
+                data.push_back(std::string("DASI INTERLEAVED BATCH TEST DATA ") + key1 + " " + key3b);
+            }
+        }
+
+        std::vector<const Key*> keyPtrs;
+        std::vector<const void*> dataPtrs;
+        std::vector<size_t> lengths;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            keyPtrs.push_back(&keys[i]);
+            dataPtrs.push_back(data[i].data());
+            lengths.push_back(data[i].size());
+        }
+
+        dasi.archiveBatch(keyPtrs.data(), dataPtrs.data(), lengths.data(), keyPtrs.size());
+        dasi.flush();
+
+        for (size_t i = 0; i < keys.size(); ++i) {
+            dasi::Query query;
+            for (const auto& kv : keys[i]) { query.set(kv.first, {kv.second}); }
+            eckit::MemoryHandle mh;
+            dasi.retrieve(query).dataHandle()->saveInto(mh);
+            EXPECT(mh.size() == data[i].size());
+            EXPECT(memcmp(mh.data(), data[i].data(), data[i].size()) == 0);
+        }
+    }
+}
+
+CASE("Archive data with a prepared prefix") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    const dasi::Key prefix {{"key1", "value1"},   {"key2", "value2"},   {"key3", "value3"},
+                            {"key1a", "value1a"}, {"key2a", "value2a"}, {"key3a", "value3a"}};
+
+    SECTION("prefix must resolve the database") {
+        EXPECT_THROWS_AS(dasi.prepare({{"key1", "value1"}}), eckit::UserError);
+    }
+
+    SECTION("leaf may not repeat the prefix") {
+        auto handle = dasi.prepare(prefix);
+        const std::string data = "DATA";
+        EXPECT_THROWS_AS(handle.archive({{"key1", "other"}}, data.data(), data.size()), eckit::UserError);
+    }
+
+    SECTION("archive through the handle") {
+        const auto keys = KeySet({"value3b1", "value3b2", "value3b3"});
+
+        auto handle = dasi.prepare(prefix);
+        EXPECT(handle.prefix() == prefix);
+
+        for (const char* value : {"value3b1", "value3b2", "value3b3"}) {
+            const std::string data = std::string("DASI PREPARED ARCHIVE TEST DATA ") + value;
+            handle.archive({{"key1b", "value1b"}, {"key2b", "value2b"}, {"key3b", value}}, data.data(), data.size());
+        }
+
+        dasi.flush();
+
+        dasi::Query query {{"key1", {"value1"}}, {"key2", {"value2"}}, {"key3", {"value3"}}};
+        auto list = dasi.list(query);
+        EXPECT(keys.lookup(list) == keys.size());
+    }
+}
+
+/// Returns some data, then fails to read any more
+class FailingHandle : public eckit::DataHandle {
+
+public: // methods
+
+    explicit FailingHandle(std::string data) : data_(std::move(data)) {}
+
+    eckit::Length openForRead() override {
+        failed_ = false;
+        return data_.size();
+    }
+
+    long read(void* buffer, long length) override {
+        if (failed_) return -1;
+        failed_ = true;
+        const size_t n = std::min(size_t(length), data_.size());
+        ::memcpy(buffer, data_.data(), n);
+        return n;
+    }
+
+    void close() override {}
+
+private: // methods
+
+    void print(std::ostream& s) const override { s << "FailingHandle"; }
+
+private: // members
+
+    std::string data_;
+    bool failed_ = false;
+};
+
+CASE("Archive data in pieces") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    const dasi::Key key = *KeySet({"streamed"}).begin();
+    dasi::Query query;
+    for (const auto& kv : key) { query.set(kv.first, {kv.second}); }
+
+    std::string data;
+    while (data.size() < 300000) { data += "DASI STREAMED ARCHIVE TEST DATA " + std::to_string(data.size()) + " "; }
+
+    auto retrieve = [&] {
+        eckit::MemoryHandle mh;
+        dasi.retrieve(query).dataHandle()->saveInto(mh);
+        return std::string(static_cast<const char*>(mh.data()), mh.size());
+    };
+
+    auto archiveInPieces = [&](const std::string& object) {
+        auto stream = dasi.archiveStream(key);
+        for (size_t pos = 0; pos < object.size(); pos += 65536) {
+            stream.write(object.data() + pos, std::min(size_t(65536), object.size() - pos));
+        }
+        EXPECT(stream.commit() == object.size());
+        EXPECT_THROWS_AS(stream.write(object.data(), 1), eckit::UserError);
+    };
+
+    SECTION("The pieces are stored as one object") {
+        archiveInPieces(data);
+        dasi.flush();
+        EXPECT(dasi.count(query) == 1);
+        EXPECT(retrieve() == data);
+    }
+
+    SECTION("Nothing is indexed until the stream is committed") {
+        {
+            auto stream = dasi.archiveStream(key);
+            stream.write(data.data(), data.size());
+        }
+        dasi.flush();
+        EXPECT(dasi.count(query) == 0);
+    }
+
+    SECTION("Streamed and whole objects replace each other") {
+        const std::string replacement = "DASI REPLACEMENT TEST DATA";
+        archiveInPieces(data);
+        dasi.archive(key, replacement.data(), replacement.size());
+        dasi.flush();
+        EXPECT(retrieve() == replacement);
+
+        archiveInPieces(data);
+        dasi.flush();
+        EXPECT(retrieve() == data);
+    }
+
+    SECTION("Archive from a data handle") {
+        eckit::MemoryHandle mh(data.data(), data.size());
+        dasi.archive(key, mh);
+        dasi.flush();
+        EXPECT(retrieve() == data);
+    }
+
+    SECTION("Read errors are reported, and nothing is indexed") {
+        FailingHandle handle(data.substr(0, 1000));
+        EXPECT_THROWS_AS(dasi.archive(key, handle), eckit::ReadError);
+        dasi.flush();
+        EXPECT(dasi.count(query) == 0);
+    }
+}
+
+CASE("Compressed archive and retrieve") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    std::string type;
+    for (const char* candidate : {"lz4", "snappy", "bzip2"}) {
+        if (eckit::CompressorFactory::instance().has(candidate)) {
+            type = candidate;
+            break;
+        }
+    }
+    if (type.empty()) {
+        LOG_I("No compressor available, skipping");
+        return;
+    }
+
+    // Small chunks, so that the object is compressed in parallel
+    auto cfg = simpleConfig(tempDir, "simple_schema");
+    cfg += "compression:\n"
+           "  type: " + type + "\n"
+           "  chunk_bytes: 65536\n"
+           "  threads: 4\n";
+
+    std::string compressible;
+    while (compressible.size() < 1024 * 1024) {
+        compressible += "DASI COMPRESSIBLE TEST DATA " + std::to_string(compressible.size() % 97) + " ";
+    }
+    const std::string incompressible = "tiny";
+
+    const auto keys = KeySet({"compressible", "incompressible"});
+
+    {
+        dasi::Dasi dasi(cfg.c_str());
+        for (auto&& key : keys) {
+            const auto& data = (key.get("key3b") == "compressible") ? compressible : incompressible;
+            dasi.archive(key, data.data(), data.size());
+        }
+        dasi.flush();
+    }
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    for (auto&& key : keys) {
+        const auto& data = (key.get("key3b") == "compressible") ? compressible : incompressible;
+
+        dasi::Query query;
+        for (const auto& kv : key) { query.set(kv.first, {kv.second}); }
+
+        // The listing reports the logical length, whatever is stored
+        size_t count = 0;
+        for (const auto& elem : dasi.list(query)) {
+            EXPECT(elem.location.length == eckit::Length(data.size()));
+            ++count;
+        }
+        EXPECT(count == 1);
+
+        // The retrieved elements are where the data is stored, and its length is read on request
+        auto result = dasi.retrieve(query);
+        EXPECT(result.count() == 1);
+        for (const auto& elem : result) {
+            EXPECT(elem.location.length > eckit::Length(0));
+            EXPECT(result.dataLength() == data.size());
+            EXPECT(!result.checksum().has_value());
+        }
+
+        eckit::MemoryHandle mh;
+        result.dataHandle()->saveInto(mh);
+        EXPECT(mh.size() == data.size());
+        EXPECT(memcmp(mh.data(), data.data(), data.size()) == 0);
+    }
+
+    SECTION("Compressed objects can be sized and seeked") {
+        dasi::Query query;
+        for (auto&& key : keys) {
+            if (key.get("key3b") != "compressible") continue;
+            for (const auto& kv : key) { query.set(kv.first, {kv.second}); }
+        }
+
+        size_t count = 0;
+        for (const auto& elem : dasi.list(query, ListOptions{ListFields::Locations})) {
+            EXPECT(elem.location.length < eckit::Length(compressible.size()));
+
+            auto metrics = std::make_shared<Metrics>();
+            MeteredHandle dh(new DecodeHandle(new eckit::PartFileHandle(elem.location.uri.path(), elem.location.offset,
+                                                                        elem.location.length)),
+                             metrics);
+            EXPECT(dh.size() == eckit::Length(compressible.size()));
+            EXPECT(dh.canSeek());
+
+            dh.openForRead();
+            eckit::AutoClose closer(dh);
+
+            // Part way through a chunk, so that the chunk is decoded from its start
+            std::vector<char> buffer(1000);
+            const size_t middle = compressible.size() / 2 + 1234;
+            EXPECT(dh.seek(middle) == eckit::Offset(middle));
+            EXPECT(dh.read(buffer.data(), buffer.size()) == long(buffer.size()));
+            EXPECT(memcmp(buffer.data(), compressible.data() + middle, buffer.size()) == 0);
+
+            // Into the next chunk
+            dh.skip(65536);
+            const size_t next = middle + buffer.size() + 65536;
+            EXPECT(dh.position() == eckit::Offset(next));
+            EXPECT(dh.read(buffer.data(), buffer.size()) == long(buffer.size()));
+            EXPECT(memcmp(buffer.data(), compressible.data() + next, buffer.size()) == 0);
+            ++count;
+        }
+        EXPECT(count == 1);
+    }
+
+    SECTION("Objects archived in pieces are compressed") {
+        const dasi::Key key = *KeySet({"streamed"}).begin();
+        dasi::Query query;
+        for (const auto& kv : key) { query.set(kv.first, {kv.second}); }
+
+        auto stream = dasi.archiveStream(key);
+        for (size_t pos = 0; pos < compressible.size(); pos += 100000) {
+            stream.write(compressible.data() + pos, std::min(size_t(100000), compressible.size() - pos));
+        }
+        stream.commit();
+        dasi.flush();
+
+        for (const auto& elem : dasi.list(query, ListOptions{ListFields::Locations})) {
+            EXPECT(elem.location.length < eckit::Length(compressible.size()));
+        }
+        eckit::MemoryHandle mh;
+        dasi.retrieve(query).dataHandle()->saveInto(mh);
+        EXPECT(mh.size() == compressible.size());
+        EXPECT(memcmp(mh.data(), compressible.data(), compressible.size()) == 0);
+    }
+
+    SECTION("Data stored without compression is returned as archived, even if it looks compressed") {
+        dasi::Query query;
+        for (auto&& key : keys) {
+            if (key.get("key3b") != "incompressible") continue;
+            for (const auto& kv : key) { query.set(kv.first, {kv.second}); }
+        }
+
+        // The stored object, envelope and all
+        eckit::MemoryHandle stored;
+        for (const auto& elem : dasi.list(query, ListOptions{ListFields::Locations})) {
+            eckit::PartFileHandle dh(elem.location.uri.path(), elem.location.offset, elem.location.length);
+            dh.saveInto(stored);
+        }
+        EXPECT(stored.size() > eckit::Length(incompressible.size()));
+
+        TempDirectory plainDir;
+        simpleWrite(plainDir, "simple_schema", SIMPLE_SCHEMA);
+        const auto plainCfg = simpleConfig(plainDir, "simple_schema");
+        dasi::Dasi plain(plainCfg.c_str());
+        plain.archive(*keys.begin(), stored.data(), stored.size());
+        plain.flush();
+
+        dasi::Query plainQuery;
+        for (const auto& kv : *keys.begin()) { plainQuery.set(kv.first, {kv.second}); }
+        for (const auto& elem : plain.list(plainQuery)) {
+            EXPECT(elem.location.length == stored.size());
+        }
+        eckit::MemoryHandle mh;
+        plain.retrieve(plainQuery).dataHandle()->saveInto(mh);
+        EXPECT(mh.size() == stored.size());
+        EXPECT(memcmp(mh.data(), stored.data(), stored.size()) == 0);
+    }
+
+    SECTION("Unknown compression types are rejected") {
+        auto badCfg = simpleConfig(tempDir, "simple_schema");
+        badCfg += "compression: no-such-compressor\n";
+        EXPECT_THROWS_AS(dasi::Dasi(badCfg.c_str()), eckit::UserError);
+    }
+}
+
+CASE("Checksummed archive and retrieve") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema") + "checksum: true\n";
+
+    const dasi::Key key = *KeySet({"checksummed"}).begin();
+    const std::string data = "DASI CHECKSUMMED ARCHIVE TEST DATA";
+
+    dasi::Query query;
+    for (const auto& kv : key) { query.set(kv.first, {kv.second}); }
+
+    {
+        dasi::Dasi dasi(cfg.c_str());
+        dasi.archive(key, data.data(), data.size());
+        dasi.flush();
+    }
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    eckit::PathName path;
+    eckit::Offset offset;
+    size_t count = 0;
+    for (const auto& elem : dasi.list(query)) {
+        EXPECT(elem.checksum.has_value());
+        EXPECT(*elem.checksum == crc32c(0, data.data(), data.size()));
+        EXPECT(elem.location.length == eckit::Length(data.size()));
+        path = elem.location.uri.path();
+        offset = elem.location.offset;
+        ++count;
+    }
+    EXPECT(count == 1);
+
+    {
+        auto result = dasi.retrieve(query);
+        for (const auto& elem : result) {
+            (void)elem;
+            EXPECT(result.checksum() == crc32c(0, data.data(), data.size()));
+        }
+        eckit::MemoryHandle mh;
+        result.dataHandle()->saveInto(mh);
+        EXPECT(mh.size() == data.size());
+        EXPECT(memcmp(mh.data(), data.data(), data.size()) == 0);
+    }
+
+    // Corrupt the last byte of the stored data
+
+    {
+        std::fstream fs(path.asString(), std::ios::in | std::ios::out | std::ios::binary);
+        const std::streamoff last = std::streamoff(offset) + std::streamoff(48 + data.size() - 1);
+        fs.seekp(last);
+        fs.put('!');
+        EXPECT(fs.good());
+    }
+
+    SECTION("Corruption is detected on retrieve") {
+        eckit::MemoryHandle mh;
+        EXPECT_THROWS_AS(dasi.retrieve(query).dataHandle()->saveInto(mh), eckit::ReadError);
+    }
+
+    SECTION("Only a full list reads the checksums") {
+        ListOptions options;
+        options.fields = ListFields::Locations;
+        for (const auto& elem : dasi.list(query, options)) {
+            EXPECT(!elem.checksum.has_value());
+            EXPECT(elem.location.length > eckit::Length(data.size()));
+        }
+    }
+
+    SECTION("Objects in spaces without checksums are listed as stored") {
+        TempDirectory plainDir;
+        simpleWrite(plainDir, "simple_schema", SIMPLE_SCHEMA);
+        const auto plainCfg = simpleConfig(plainDir, "simple_schema");
+        dasi::Dasi plain(plainCfg.c_str());
+        plain.archive(key, data.data(), data.size());
+        plain.flush();
+        for (const auto& elem : plain.list(query)) {
+            EXPECT(!elem.checksum.has_value());
+            EXPECT(elem.location.length == eckit::Length(data.size()));
+        }
+    }
+
+    SECTION("Verification can be disabled") {
+        dasi::Dasi unverified(cfg.c_str(), "retrieve:\n  verify_checksum: false\n");
+        eckit::MemoryHandle mh;
+        unverified.retrieve(query).dataHandle()->saveInto(mh);
+        EXPECT(mh.size() == data.size());
+        EXPECT(memcmp(mh.data(), data.data(), data.size() - 1) == 0);
+        EXPECT(static_cast<const char*>(mh.data())[data.size() - 1] == '!');
+    }
+}
+
+CASE("Deduplicated archive") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    const std::string payload = "DASI DEDUPLICATED ARCHIVE TEST DATA";
+    const std::string other = "DASI DIFFERENT ARCHIVE TEST DATA";
+    const auto keys = KeySet({"orig", "dup1", "dup2", "other"});
+
+    auto lookup = [&keys](const char* value) {
+        for (const auto& key : keys) {
+            if (key.get("key3b") == value) return key;
+        }
+        throw eckit::SeriousBug("Missing test key", Here());
+    };
+
+    auto toQuery = [](const Key& key) {
+        dasi::Query query;
+        for (const auto& kv : key) { query.set(kv.first, {kv.second}); }
+        return query;
+    };
+
+    dasi::Dasi dasi(cfg.c_str(), "archive:\n  dedup: true\n");
+
+    dasi.archive(lookup("orig"), payload.data(), payload.size());
+    dasi.archive(lookup("dup1"), payload.data(), payload.size());
+    dasi.archive(lookup("other"), other.data(), other.size());
+    dasi.archive(lookup("dup2"), payload.data(), payload.size());
+
+    SECTION("Duplicates share the location of the original") {
+        dasi.flush();
+
+        auto query = toQuery(lookup("orig"));
+        query.set("key3b", {"orig", "dup1", "dup2", "other"});
+
+        std::map<std::string, DataLocation> locations;
+        for (const auto& elem : dasi.list(query)) {
+            locations[elem.key.get("key3b")] = elem.location;
+        }
+        EXPECT(locations.size() == 4);
+        for (const char* dup : {"dup1", "dup2"}) {
+            EXPECT(locations[dup].uri.asString() == locations["orig"].uri.asString());
+            EXPECT(locations[dup].offset == locations["orig"].offset);
+        }
+        EXPECT(locations["other"].offset != locations["orig"].offset);
+    }
+
+    SECTION("Overwriting the original does not change its duplicates") {
+        const std::string replacement = "DASI REPLACEMENT TEST DATA";
+        dasi.archive(lookup("orig"), replacement.data(), replacement.size());
+        dasi.flush();
+
+        for (const char* value : {"orig", "dup1", "dup2"}) {
+            const auto& expected = (std::string(value) == "orig") ? replacement : payload;
+            eckit::MemoryHandle mh;
+            dasi.retrieve(toQuery(lookup(value))).dataHandle()->saveInto(mh);
+            EXPECT(mh.size() == expected.size());
+            EXPECT(memcmp(mh.data(), expected.data(), expected.size()) == 0);
+        }
+    }
+
+    SECTION("Only the most recent originals are remembered") {
+        dasi.flush();
+
+        dasi::Dasi bounded(cfg.c_str(), "archive:\n  dedup: true\n  dedup_max_objects: 1\n");
+
+        auto withValue = [&](const char* value) {
+            auto key = lookup("orig");
+            key.set("key3b", value);
+            return key;
+        };
+
+        bounded.archive(withValue("lru_orig"), payload.data(), payload.size());
+        bounded.archive(withValue("lru_other"), other.data(), other.size());
+        bounded.archive(withValue("lru_dup"), payload.data(), payload.size());
+        bounded.flush();
+
+        auto query = toQuery(lookup("orig"));
+        query.set("key3b", {"lru_orig", "lru_dup"});
+
+        std::map<std::string, DataLocation> locations;
+        for (const auto& elem : bounded.list(query)) {
+            locations[elem.key.get("key3b")] = elem.location;
+        }
+        EXPECT(locations.size() == 2);
+        EXPECT(locations["lru_dup"].offset != locations["lru_orig"].offset);
+    }
 }
 
 CASE("Archive data and check list and retrieve") {
@@ -136,6 +711,515 @@ CASE("Archive data and check list and retrieve") {
     }*/
 }
 
+CASE("List with ranges") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    const auto keys = KeySet({"1", "2", "3", "4", "5"});
+    const std::string data = "DASI RANGE TEST DATA";
+    for (const auto& key : keys) {
+        dasi.archive(key, data.data(), data.size());
+    }
+    dasi.flush();
+
+    const std::string prefix = "key1=value1,key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                               "key1b=value1b,key2b=value2b,";
+
+    auto count = [&dasi](const std::string& query) {
+        auto list = dasi.list(dasi::Query(query));
+        size_t n = 0;
+        for (const auto& elem : list) { (void)elem; ++n; }
+        return n;
+    };
+
+    EXPECT(count(prefix + "key3b=2/to/4") == 3);
+    EXPECT(count(prefix + "key3b=1/to/5/by/2") == 3);
+    EXPECT(count(prefix + "key3b=all") == 5);
+
+    // Ranges are expanded into the request, so must not be unbounded
+    EXPECT_THROWS_AS(count(prefix + "key3b=1/to/1000000000"), eckit::UserError);
+}
+
+CASE("List selected fields") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    auto keys = KeySet({"value3b1", "value3b2"});
+    const std::string data = "DASI LIST FIELDS DATA";
+    for (const auto& key : keys) {
+        dasi.archive(key, data.data(), data.size());
+    }
+    dasi.flush();
+
+    const dasi::Query query("key1=value1,key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                            "key1b=value1b,key2b=value2b,key3b=value3b1/value3b2");
+
+    for (auto fields : {ListFields::Keys, ListFields::KeysAndTimestamp, ListFields::Locations, ListFields::Full}) {
+        auto list = dasi.list(query, ListOptions{fields});
+        EXPECT(keys.lookup(list) == 2);
+
+        for (const auto& elem : dasi.list(query, ListOptions{fields})) {
+            EXPECT((elem.timestamp != 0) == (fields != ListFields::Keys));
+            const bool located = (fields == ListFields::Locations || fields == ListFields::Full);
+            EXPECT((elem.location.length == eckit::Length(data.size())) == located);
+        }
+    }
+}
+
+CASE("List changed since") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    const std::string prefix = "key1=value1,key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                               "key1b=value1b,key2b=value2b,key3b=";
+    const dasi::Query query(prefix + "value3b1/value3b2");
+    const std::string data = "DASI LIST SINCE DATA";
+
+    auto listed = [&dasi, &query](time_t since) {
+        std::vector<dasi::Key> found;
+        for (const auto& elem : dasi.list(query, ListOptions{ListFields::Keys, since})) { found.push_back(elem.key); }
+        EXPECT(dasi.count(query, ListOptions{ListFields::Keys, since}) == found.size());
+        return found;
+    };
+
+    dasi.archive(dasi::Key(prefix + "value3b1"), data.data(), data.size());
+    dasi.flush();
+
+    time_t latest = 0;
+    for (const auto& elem : dasi.list(query)) { latest = std::max(latest, elem.timestamp); }
+    EXPECT(latest != 0);
+
+    EXPECT(listed(0).size() == 1);
+    EXPECT(listed(latest).size() == 1);
+    EXPECT(listed(latest + 1).empty());
+
+    // Timestamps are recorded to the second
+    while (::time(nullptr) <= latest) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    dasi.archive(dasi::Key(prefix + "value3b2"), data.data(), data.size());
+    dasi.flush();
+
+    EXPECT(listed(0).size() == 2);
+    EXPECT(listed(latest + 1) == std::vector<dasi::Key>{dasi::Key(prefix + "value3b2")});
+}
+
+CASE("Axes") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    const std::string data = "DASI AXES DATA";
+    for (const auto& key : KeySet({"c", "a", "b"})) {
+        dasi.archive(key, data.data(), data.size());
+    }
+    dasi.flush();
+
+    const dasi::Query query("key1=value1,key2=value2,key3=value3");
+
+    const auto axes = dasi.axes(query);
+    EXPECT(axes.at("key1") == std::vector<std::string>{"value1"});
+    EXPECT((axes.at("key3b") == std::vector<std::string>{"a", "b", "c"}));
+    EXPECT(axes.at("key2b") == std::vector<std::string>{"value2b"});
+
+    EXPECT(dasi.axes(query, 1).at("key1") == std::vector<std::string>{"value1"});
+
+    EXPECT(dasi.axes(dasi::Query("key1=other,key2=value2,key3=value3")).empty());
+
+    EXPECT_THROWS_AS(dasi.axes(query, 0), eckit::UserError);
+}
+
+CASE("Count") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    const std::string prefix = "key1=value1,key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                               "key1b=value1b,key2b=value2b,";
+
+    EXPECT(dasi.count(dasi::Query(prefix + "key3b=all")) == 0);
+
+    const auto keys = KeySet({"1", "2", "3", "4", "5"});
+    const std::string data = "DASI COUNT TEST DATA";
+    for (const auto& key : keys) {
+        dasi.archive(key, data.data(), data.size());
+    }
+    dasi.flush();
+
+    // Overwritten objects are still present in the older index, but are only counted once
+    auto it = keys.begin();
+    for (int i = 0; i < 2; ++i, ++it) {
+        dasi.archive(*it, data.data(), data.size());
+    }
+    dasi.flush();
+
+    auto listed = [&dasi](const std::string& query) {
+        auto list = dasi.list(dasi::Query(query));
+        size_t n = 0;
+        for (const auto& elem : list) { (void)elem; ++n; }
+        return n;
+    };
+
+    EXPECT(dasi.count(dasi::Query(prefix + "key3b=all")) == 5);
+    EXPECT(dasi.count(dasi::Query(prefix + "key3b=all")) == listed(prefix + "key3b=all"));
+    EXPECT(dasi.count(dasi::Query(prefix + "key3b=2/to/4")) == 3);
+    EXPECT(dasi.count(dasi::Query(prefix + "key3b=6")) == 0);
+}
+
+CASE("Count a database found under several roots") {
+    TempDirectory tempDir;
+    TempDirectory root1(tempDir / "root1");
+    TempDirectory root2(tempDir / "root2");
+
+    root1.write("simple_schema", SIMPLE_SCHEMA);
+    root2.write("simple_schema", SIMPLE_SCHEMA);
+
+    // Archive to each root on its own, with the same database in both and an object in each of them
+    const std::string data = "DASI COUNT ROOTS DATA";
+    auto archive = [&data](const std::string& cfg, const std::vector<std::string>& keys) {
+        dasi::Dasi dasi(cfg.c_str());
+        for (const auto& key : keys) {
+            dasi.archive(dasi::Key(key), data.data(), data.size());
+        }
+        dasi.flush();
+    };
+
+    const std::string suffix = ",key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                               "key1b=value1b,key2b=value2b,key3b=";
+    archive(simpleConfig(root1, "simple_schema"),
+            {"key1=shared" + suffix + "1", "key1=shared" + suffix + "2", "key1=first" + suffix + "1"});
+    archive(simpleConfig(root2, "simple_schema"), {"key1=shared" + suffix + "2", "key1=shared" + suffix + "3"});
+
+    // Then read from both roots
+    std::ostringstream cfg;
+    cfg << simpleConfig(root1, "simple_schema") << "  - path: " << root2 << "\n";
+    dasi::Dasi dasi(cfg.str().c_str());
+
+    const dasi::Query query("key1=shared/first" + suffix + "all");
+
+    std::set<dasi::Key> unique;
+    size_t listed = 0;
+    for (const auto& elem : dasi.list(query)) {
+        unique.insert(elem.key);
+        ++listed;
+    }
+
+    EXPECT(unique.size() == 4);
+    EXPECT(listed == unique.size());
+    EXPECT(dasi.count(query) == unique.size());
+    EXPECT(dasi.count(dasi::Query("key1=shared" + suffix + "all")) == 3);
+}
+
+CASE("Parallel list") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    // Spread the objects over a number of databases
+    std::vector<dasi::Key> keys;
+    {
+        dasi::Dasi dasi(cfg.c_str());
+        const std::string data = "DASI PARALLEL LIST DATA";
+        for (int db = 0; db < 4; ++db) {
+            for (int field = 0; field < 5; ++field) {
+                keys.emplace_back("key1=value" + std::to_string(db) + ",key2=value2,key3=value3,key1a=value1a,"
+                                  "key2a=value2a,key3a=value3a,key1b=value1b,key2b=value2b,key3b=" +
+                                  std::to_string(field));
+                dasi.archive(keys.back(), data.data(), data.size());
+            }
+        }
+        dasi.flush();
+    }
+
+    const dasi::Query query("key1=all,key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                            "key1b=value1b,key2b=value2b,key3b=all");
+
+    auto listed = [&cfg, &query](const char* appConfig) {
+        dasi::Dasi dasi(cfg.c_str(), appConfig);
+        std::vector<dasi::Key> found;
+        for (const auto& elem : dasi.list(query)) { found.push_back(elem.key); }
+        return found;
+    };
+
+    const auto serial = listed(nullptr);
+    EXPECT(serial.size() == keys.size());
+
+    const auto ordered = listed("list:\n  threads: 3\n");
+    EXPECT(ordered == serial);
+
+    auto unordered = listed("list:\n  threads: 3\n  ordered: false\n");
+    EXPECT(unordered.size() == serial.size());
+    std::sort(unordered.begin(), unordered.end());
+    auto sorted = serial;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT(unordered == sorted);
+
+    // Abandoning a listing stops the workers
+    dasi::Dasi dasi(cfg.c_str(), "list:\n  threads: 2\n");
+    auto list = dasi.list(query);
+    EXPECT(list.begin() != list.end());
+}
+
+CASE("Paged list") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    // Spread the objects over a number of databases, so that pages span them
+    std::vector<dasi::Key> keys;
+    const std::string data = "DASI PAGED LIST DATA";
+    for (int db = 0; db < 3; ++db) {
+        for (int field = 0; field < 4; ++field) {
+            keys.emplace_back("key1=value" + std::to_string(db) + ",key2=value2,key3=value3,key1a=value1a,"
+                              "key2a=value2a,key3a=value3a,key1b=value1b,key2b=value2b,key3b=" +
+                              std::to_string(field));
+            dasi.archive(keys.back(), data.data(), data.size());
+        }
+    }
+    dasi.flush();
+
+    const dasi::Query query("key1=all,key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                            "key1b=value1b,key2b=value2b,key3b=all");
+
+    auto page = [&dasi, &query](const std::string& cursor, std::vector<dasi::Key>& found) {
+        ListOptions options;
+        options.limit = 5;
+        options.cursor = cursor;
+        auto list = dasi.list(query, options);
+        size_t n = 0;
+        for (const auto& elem : list) {
+            found.push_back(elem.key);
+            ++n;
+        }
+        EXPECT(n <= options.limit);
+        return list.cursor();
+    };
+
+    std::vector<dasi::Key> found;
+    std::string cursor;
+    size_t pages = 0;
+    do {
+        cursor = page(cursor, found);
+        ++pages;
+    } while (!cursor.empty());
+
+    EXPECT(pages == 3);
+    std::sort(found.begin(), found.end());
+    std::sort(keys.begin(), keys.end());
+    EXPECT(found == keys);
+
+    SECTION("A page can be listed again from the same cursor") {
+        std::vector<dasi::Key> first;
+        const auto next = page("", first);
+        std::vector<dasi::Key> again1;
+        std::vector<dasi::Key> again2;
+        EXPECT(page(next, again1) == page(next, again2));
+        EXPECT(again1 == again2);
+        EXPECT(again1.size() == 5);
+    }
+
+    SECTION("Objects archived between pages are listed once") {
+        std::vector<dasi::Key> listed;
+        auto next = page("", listed);
+        EXPECT(listed.size() == 5);
+
+        // Re-archive objects already listed, including the one the cursor refers to, and add a new
+        // one. Pages are in the order of the keys, so the new one comes after the cursor.
+        dasi.archive(listed.front(), data.data(), data.size());
+        dasi.archive(listed.back(), data.data(), data.size());
+        dasi::Key added("key1=value2,key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                        "key1b=value1b,key2b=value2b,key3b=9");
+        dasi.archive(added, data.data(), data.size());
+        dasi.flush();
+
+        while (!next.empty()) {
+            next = page(next, listed);
+        }
+
+        auto expected = keys;
+        expected.push_back(added);
+        std::sort(expected.begin(), expected.end());
+        std::sort(listed.begin(), listed.end());
+        EXPECT(listed == expected);
+    }
+
+    SECTION("A paged list is counted as one page") {
+        ListOptions options;
+        options.limit = 5;
+        EXPECT(dasi.count(query, options) == 5);
+
+        // The last page holds what remains after its cursor
+        std::vector<dasi::Key> listed;
+        options.cursor = page(page("", listed), listed);
+        EXPECT(dasi.count(query, options) == keys.size() - 10);
+        options.limit = 0;
+        EXPECT(dasi.count(query, options) == keys.size() - 10);
+    }
+
+    SECTION("Invalid cursors are rejected") {
+        ListOptions options;
+        options.cursor = "not a cursor";
+        EXPECT_THROWS_AS(dasi.list(query, options), eckit::UserError);
+    }
+
+    SECTION("Only a paged list has a cursor") {
+        auto list = dasi.list(query);
+        EXPECT_THROWS_AS((void)list.cursor(), eckit::UserError);
+    }
+}
+
+CASE("Catalogue cache") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    const std::string prefix = "key1=value1,key2=value2,key3=value3,key1a=value1a,key2a=value2a,key3a=value3a,"
+                               "key1b=value1b,key2b=value2b,key3b=";
+    const dasi::Query query(prefix.substr(0, prefix.size() - 6) + "key3b=all");
+
+    auto count = [&query](dasi::Dasi& dasi) {
+        size_t n = 0;
+        for (const auto& elem : dasi.list(query)) {
+            (void)elem;
+            ++n;
+        }
+        return n;
+    };
+
+    const std::string data = "DASI CACHED DATA";
+
+    dasi::Dasi cached(cfg.c_str(), "cache:\n  max_bytes: 1048576\n");
+    cached.archive(dasi::Key(prefix + "1"), data.data(), data.size());
+    cached.flush();
+    EXPECT(count(cached) == 1);
+    EXPECT(count(cached) == 1);
+    EXPECT(cached.stats().cache.misses == 1);
+    EXPECT(cached.stats().cache.hits == 1);
+
+    SECTION("Local archives invalidate the cache") {
+        cached.archive(dasi::Key(prefix + "2"), data.data(), data.size());
+        cached.flush();
+        EXPECT(count(cached) == 2);
+        EXPECT(count(cached) == 2);
+        EXPECT(cached.stats().cache.misses == 2);
+        EXPECT(cached.stats().cache.hits == 2);
+    }
+
+    SECTION("Archives by other writers are detected") {
+        {
+            dasi::Dasi other(cfg.c_str());
+            other.archive(dasi::Key(prefix + "2"), data.data(), data.size());
+            other.flush();
+        }
+        EXPECT(count(cached) == 2);
+        EXPECT(cached.stats().cache.stale == 1);
+        EXPECT(cached.stats().cache.misses == 2);
+        EXPECT(cached.stats().cache.hits == 1);
+    }
+
+    SECTION("Retrieve from the cache") {
+        const dasi::Query one(prefix + "1");
+        for (int i = 0; i < 2; ++i) {
+            auto result = cached.retrieve(one);
+            EXPECT(result.count() == 1);
+            eckit::MemoryHandle mh;
+            result.dataHandle()->saveInto(mh);
+            EXPECT(mh.size() == data.size());
+            EXPECT(memcmp(mh.data(), data.data(), data.size()) == 0);
+        }
+        EXPECT(cached.stats().cache.misses == 2);
+        EXPECT(cached.stats().cache.hits == 2);
+    }
+
+    SECTION("Results larger than the budget are streamed, not cached") {
+        dasi::Dasi small(cfg.c_str(), "cache:\n  max_bytes: 1\n");
+        small.archive(dasi::Key(prefix + "2"), data.data(), data.size());
+        small.flush();
+        EXPECT(count(small) == 2);
+        EXPECT(count(small) == 2);
+        EXPECT(small.retrieve(query).count() == 2);
+        EXPECT(small.stats().cache.misses == 3);
+        EXPECT(small.stats().cache.hits == 0);
+    }
+}
+
+CASE("Operation statistics") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    const auto keys = KeySet({"value3b1", "value3b2"});
+    const std::string data = "DASI STATISTICS TEST DATA";
+
+    for (const auto& key : keys) {
+        dasi.archive(key, data.data(), data.size());
+    }
+    dasi.flush();
+
+    dasi::Query query {{"key1", {"value1"}}, {"key2", {"value2"}}, {"key3", {"value3"}}};
+    auto list = dasi.list(query);
+    EXPECT(keys.lookup(list) == keys.size());
+
+    eckit::MemoryHandle mh;
+    dasi.retrieve(query).dataHandle()->saveInto(mh);
+
+    const auto stats = dasi.stats();
+
+    EXPECT(stats.archive.calls == 2);
+    EXPECT(stats.archive.bytes == 2 * data.size());
+    EXPECT(stats.flush.calls == 1);
+    EXPECT(stats.list.calls == 1);
+    EXPECT(stats.retrieve.calls == 1);
+    EXPECT(stats.retrieve.bytes == 2 * data.size());
+    EXPECT(stats.read.bytes == 2 * data.size());
+    EXPECT(stats.wipe.calls == 0);
+
+    size_t histogramCalls = 0;
+    for (const auto n : stats.archive.latency) { histogramCalls += n; }
+    EXPECT(histogramCalls == stats.archive.calls);
+    EXPECT(stats.archive.percentile(100) >= stats.archive.percentile(50));
+
+    std::ostringstream json;
+    stats.json(json);
+    EXPECT(json.str().find("\"archive\"") != std::string::npos);
+}
+
 }  // namespace dasi::testing
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/log/Timer.h"
+
+#include "dasi/api/Dasi.h"
+
+#include "helper.h"
+
+#include <vector>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t NUM_OBJECTS = 5000;
+constexpr size_t OBJECT_SIZE = 1024;
+
+std::vector<Key> makeKeys(const char* step) {
+    std::vector<Key> keys;
+    keys.reserve(NUM_OBJECTS);
+    for (size_t i = 0; i < NUM_OBJECTS; ++i) {
+        keys.push_back({{"key1", "value1"},
+                        {"key2", "value2"},
+                        {"key3", "value3"},
+                        {"key1a", "value1a"},
+                        {"key2a", "value2a"},
+                        {"key3a", step},
+                        {"key1b", "value1b"},
+                        {"key2b", "value2b"},
+                        {"key3b", std::to_string(i)}});
+    }
+    return keys;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Benchmark batched archive against one-at-a-time archive") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    const std::vector<char> data(OBJECT_SIZE, 'x');
+
+    double loopTime = 0;
+    double batchTime = 0;
+
+    {
+        const auto keys = makeKeys("loop");
+        eckit::Timer timer("archive loop", eckit::Log::debug<LibDasi>());
+        for (const auto& key : keys) { dasi.archive(key, data.data(), data.size()); }
+        dasi.flush();
+        loopTime = timer.elapsed();
+    }
+
+    {
+        const auto keys = makeKeys("batch");
+
+        std::vector<const Key*> keyPtrs;
+        std::vector<const void*> dataPtrs(NUM_OBJECTS, data.data());
+        std::vector<size_t> lengths(NUM_OBJECTS, data.size());
+        for (const auto& key : keys) { keyPtrs.push_back(&key); }
+
+        eckit::Timer timer("archive batch", eckit::Log::debug<LibDasi>());
+        dasi.archiveBatch(keyPtrs.data(), dataPtrs.data(), lengths.data(), NUM_OBJECTS);
+        dasi.flush();
+        batchTime = timer.elapsed();
+    }
+
+    LOG_I("archive " << NUM_OBJECTS << " x " << OBJECT_SIZE << " bytes: loop=" << loopTime << "s, batch="
+                     << batchTime << "s, speedup=" << (batchTime > 0 ? loopTime / batchTime : 0));
+
+    // Both approaches must have archived everything
+
+    for (const char* step : {"loop", "batch"}) {
+        dasi::Query query {{"key1", {"value1"}}, {"key2", {"value2"}}, {"key3", {"value3"}}, {"key3a", {step}}};
+        size_t count = 0;
+        for (const auto& elem : dasi.list(query)) {
+            (void)elem;
+            ++count;
+        }
+        EXPECT(count == NUM_OBJECTS);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
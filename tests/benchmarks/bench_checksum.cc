@@ -0,0 +1,94 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/log/Timer.h"
+
+#include "dasi/api/Dasi.h"
+#include "dasi/impl/Crc32c.h"
+
+#include "helper.h"
+
+#include <vector>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t BUFFER_SIZE = 64 * 1024 * 1024;
+constexpr size_t REPEATS = 8;
+
+constexpr size_t NUM_OBJECTS = 64;
+constexpr size_t OBJECT_SIZE = 1024 * 1024;
+
+double archiveTime(const std::string& cfg, const std::vector<char>& data, const char* step) {
+
+    dasi::Dasi dasi(cfg.c_str());
+
+    eckit::Timer timer(step, eckit::Log::debug<LibDasi>());
+    for (size_t i = 0; i < NUM_OBJECTS; ++i) {
+        const Key key {{"key1", "value1"},   {"key2", "value2"},   {"key3", "value3"},
+                       {"key1a", "value1a"}, {"key2a", "value2a"}, {"key3a", step},
+                       {"key1b", "value1b"}, {"key2b", "value2b"}, {"key3b", std::to_string(i)}};
+        dasi.archive(key, data.data(), data.size());
+    }
+    dasi.flush();
+    return timer.elapsed();
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Benchmark CRC-32C throughput") {
+
+    std::vector<char> data(BUFFER_SIZE);
+    for (size_t i = 0; i < data.size(); ++i) { data[i] = static_cast<char>(i * 31 + 7); }
+
+    uint32_t crc = 0;
+    eckit::Timer timer("crc32c", eckit::Log::debug<LibDasi>());
+    for (size_t i = 0; i < REPEATS; ++i) { crc = crc32c(crc, data.data(), data.size()); }
+    const double elapsed = timer.elapsed();
+
+    const double gbytes = double(BUFFER_SIZE) * REPEATS / (1024. * 1024. * 1024.);
+    LOG_I("crc32c (" << (crc32cHardware() ? "hardware" : "software") << "): " << gbytes << " GiB in " << elapsed
+                     << "s, " << (elapsed > 0 ? gbytes / elapsed : 0) << " GiB/s");
+}
+
+CASE("Benchmark archive with and without checksums") {
+    TempDirectory tempDir;
+
+    simpleWrite(tempDir, "simple_schema", SIMPLE_SCHEMA);
+
+    const auto cfg = simpleConfig(tempDir, "simple_schema");
+
+    const std::vector<char> data(OBJECT_SIZE, 'x');
+
+    const double plainTime = archiveTime(cfg, data, "plain");
+    const double checksumTime = archiveTime(cfg + "checksum: true\n", data, "checksum");
+
+    LOG_I("archive " << NUM_OBJECTS << " x " << OBJECT_SIZE << " bytes: plain=" << plainTime
+                     << "s, checksum=" << checksumTime << "s");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
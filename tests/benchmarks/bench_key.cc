@@ -0,0 +1,147 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/log/Timer.h"
+
+#include "dasi/api/Key.h"
+
+#include "helper.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t NUM_KEYS = 10000;
+constexpr size_t REPEATS = 20;
+
+// The node-based layout that Key used to have, as a baseline
+using MapKey = std::map<std::string, std::string, std::less<>>;
+
+const std::vector<std::string> keywords {"class", "stream", "expver", "date",  "time",  "type",
+                                         "levtype", "levelist", "param", "step", "number"};
+
+std::string valueFor(size_t keyword, size_t i) {
+    return keywords[keyword] + std::to_string((i * 7919 + keyword) % 1000);
+}
+
+std::vector<Key> makeKeys() {
+    std::vector<Key> keys(NUM_KEYS);
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+        for (size_t k = 0; k < keywords.size(); ++k) { keys[i].set(keywords[k], valueFor(k, i)); }
+    }
+    return keys;
+}
+
+std::vector<MapKey> makeMapKeys() {
+    std::vector<MapKey> keys(NUM_KEYS);
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+        for (size_t k = 0; k < keywords.size(); ++k) { keys[i].insert_or_assign(keywords[k], valueFor(k, i)); }
+    }
+    return keys;
+}
+
+void report(const char* what, double keyTime, double mapTime) {
+    LOG_I(what << ": Key=" << keyTime << "s, std::map=" << mapTime << "s ("
+               << (keyTime > 0 ? mapTime / keyTime : 0) << "x)");
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Benchmark Key construction") {
+
+    size_t total = 0;
+
+    eckit::Timer keyTimer("Key construction", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) { total += makeKeys().size(); }
+    const double keyTime = keyTimer.elapsed();
+
+    eckit::Timer mapTimer("std::map construction", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) { total += makeMapKeys().size(); }
+    const double mapTime = mapTimer.elapsed();
+
+    report("construction", keyTime, mapTime);
+    EXPECT(total == 2 * REPEATS * NUM_KEYS);
+}
+
+CASE("Benchmark Key lookup") {
+
+    const auto keys = makeKeys();
+    const auto mapKeys = makeMapKeys();
+
+    size_t found = 0;
+
+    eckit::Timer keyTimer("Key lookup", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (const auto& key : keys) {
+            for (const auto& keyword : keywords) { found += key.get(keyword).size(); }
+        }
+    }
+    const double keyTime = keyTimer.elapsed();
+
+    size_t mapFound = 0;
+
+    eckit::Timer mapTimer("std::map lookup", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (const auto& key : mapKeys) {
+            for (const auto& keyword : keywords) { mapFound += key.find(keyword)->second.size(); }
+        }
+    }
+    const double mapTime = mapTimer.elapsed();
+
+    report("lookup", keyTime, mapTime);
+    EXPECT(found == mapFound);
+}
+
+CASE("Benchmark Key comparison") {
+
+    const auto keys = makeKeys();
+    const auto mapKeys = makeMapKeys();
+
+    size_t less = 0;
+
+    eckit::Timer keyTimer("Key comparison", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (size_t i = 1; i < keys.size(); ++i) { less += (keys[i - 1] < keys[i]) ? 1 : 0; }
+    }
+    const double keyTime = keyTimer.elapsed();
+
+    size_t mapLess = 0;
+
+    eckit::Timer mapTimer("std::map comparison", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (size_t i = 1; i < mapKeys.size(); ++i) { mapLess += (mapKeys[i - 1] < mapKeys[i]) ? 1 : 0; }
+    }
+    const double mapTime = mapTimer.elapsed();
+
+    report("operator<", keyTime, mapTime);
+    EXPECT(less == mapLess);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
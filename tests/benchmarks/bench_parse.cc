@@ -0,0 +1,116 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/log/Timer.h"
+#include "eckit/utils/StringTools.h"
+
+#include "dasi/api/Key.h"
+#include "dasi/api/Query.h"
+
+#include "helper.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t NUM_STRINGS = 1000;
+constexpr size_t REPEATS = 100;
+
+std::vector<std::string> makeStrings(bool query) {
+    std::vector<std::string> strings;
+    strings.reserve(NUM_STRINGS);
+    for (size_t i = 0; i < NUM_STRINGS; ++i) {
+        std::string s = "class=od,stream=oper,expver=0001,date=20231001,time=1200,type=fc,levtype=ml,param=" +
+                        std::to_string(i % 300);
+        s += query ? ",levelist=1/2/3/4/5/6/7/8/9/10,step=0/6/12/18/24" : ",levelist=" + std::to_string(i % 137);
+        strings.push_back(std::move(s));
+    }
+    return strings;
+}
+
+// The split-based parser that Query used to have, as a baseline
+std::map<std::string, std::vector<std::string>, std::less<>> splitParse(const std::string& str) {
+    std::map<std::string, std::vector<std::string>, std::less<>> values;
+    for (const std::string& bit : eckit::StringTools::split(",", str)) {
+        auto kvs = eckit::StringTools::split("=", bit);
+        values.emplace(std::move(kvs[0]), eckit::StringTools::split("/", kvs[1]));
+    }
+    return values;
+}
+
+double throughput(const std::vector<std::string>& strings, double elapsed) {
+    size_t bytes = 0;
+    for (const auto& s : strings) { bytes += s.size(); }
+    return elapsed > 0 ? double(bytes) * REPEATS / elapsed / (1024. * 1024.) : 0;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Benchmark Key parsing") {
+
+    const auto strings = makeStrings(false);
+    size_t total = 0;
+
+    eckit::Timer timer("Key parsing", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (const auto& s : strings) { total += Key(s).size(); }
+    }
+    const double elapsed = timer.elapsed();
+
+    LOG_I("Key parsing: " << NUM_STRINGS * REPEATS << " strings in " << elapsed << "s, "
+                          << throughput(strings, elapsed) << " MiB/s");
+    EXPECT(total == 9 * NUM_STRINGS * REPEATS);
+}
+
+CASE("Benchmark Query parsing") {
+
+    const auto strings = makeStrings(true);
+    size_t total = 0;
+    size_t splitTotal = 0;
+
+    eckit::Timer timer("Query parsing", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (const auto& s : strings) { total += Query(s).size(); }
+    }
+    const double elapsed = timer.elapsed();
+
+    eckit::Timer splitTimer("split parsing", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (const auto& s : strings) { splitTotal += splitParse(s).size(); }
+    }
+    const double splitElapsed = splitTimer.elapsed();
+
+    LOG_I("Query parsing: " << NUM_STRINGS * REPEATS << " strings in " << elapsed << "s, "
+                            << throughput(strings, elapsed) << " MiB/s (split-based: "
+                            << throughput(strings, splitElapsed) << " MiB/s)");
+    EXPECT(total == splitTotal);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
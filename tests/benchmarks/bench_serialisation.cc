@@ -0,0 +1,134 @@
+/*
+ * Copyright 2023- European Centre for Medium-Range Weather Forecasts (ECMWF).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eckit/log/Timer.h"
+
+#include "dasi/api/Serialisation.h"
+
+#include "helper.h"
+
+#include <string>
+#include <vector>
+
+namespace dasi::testing {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t NUM_KEYS = 1000;
+constexpr size_t REPEATS = 100;
+
+std::vector<Key> makeKeys() {
+    std::vector<Key> keys;
+    keys.reserve(NUM_KEYS);
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+        keys.emplace_back(Key{{"class", "od"}, {"stream", "oper"}, {"expver", "0001"}, {"date", "20231001"},
+                              {"time", "1200"}, {"type", "fc"}, {"levtype", "ml"},
+                              {"param", std::to_string(i % 300)}, {"levelist", std::to_string(i % 137)}});
+    }
+    return keys;
+}
+
+// The comma-separated text form, as accepted by the Key constructor
+std::string toText(const Key& key) {
+    std::string s;
+    for (const auto& kv : key) {
+        if (!s.empty()) s += ',';
+        s += kv.first.str();
+        s += '=';
+        s += kv.second;
+    }
+    return s;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Benchmark Key serialisation") {
+
+    const auto keys = makeKeys();
+
+    size_t textBytes = 0;
+    size_t textTotal = 0;
+    eckit::Timer textTimer("text serialisation", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (const auto& key : keys) {
+            std::string text = toText(key);
+            textBytes += text.size();
+            textTotal += Key(text).size();
+        }
+    }
+    const double textElapsed = textTimer.elapsed();
+
+    size_t binaryBytes = 0;
+    size_t binaryTotal = 0;
+    Encoder encoder;
+    Key decoded;
+    eckit::Timer binaryTimer("binary serialisation", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        encoder.clear();
+        for (const auto& key : keys) { encoder.encode(key); }
+        binaryBytes += encoder.buffer().size();
+        Decoder decoder(encoder.buffer().data(), encoder.buffer().size());
+        while (!decoder.done()) {
+            decoder.decode(decoded);
+            binaryTotal += decoded.size();
+        }
+    }
+    const double binaryElapsed = binaryTimer.elapsed();
+
+    LOG_I("Key serialisation: " << NUM_KEYS * REPEATS << " keys. Text: " << textBytes / (NUM_KEYS * REPEATS)
+                                << " bytes/key in " << textElapsed << "s. Binary stream: "
+                                << binaryBytes / (NUM_KEYS * REPEATS) << " bytes/key in " << binaryElapsed << "s");
+    EXPECT(binaryTotal == textTotal);
+    EXPECT(binaryBytes < textBytes);
+}
+
+CASE("Benchmark single Key serialisation") {
+
+    const auto keys = makeKeys();
+
+    size_t textBytes = 0;
+    for (const auto& key : keys) { textBytes += toText(key).size(); }
+
+    size_t bytes = 0;
+    size_t total = 0;
+    eckit::Timer timer("single key serialisation", eckit::Log::debug<LibDasi>());
+    for (size_t r = 0; r < REPEATS; ++r) {
+        for (const auto& key : keys) {
+            std::string data = encode(key);
+            bytes += data.size();
+            total += decodeKey(data).size();
+        }
+    }
+    const double elapsed = timer.elapsed();
+
+    // Without a stream to share the keywords, the records are no smaller than the text
+    LOG_I("Single key serialisation: " << NUM_KEYS * REPEATS << " keys, " << bytes / (NUM_KEYS * REPEATS)
+                                       << " bytes/key (text: " << textBytes / NUM_KEYS << " bytes/key) in " << elapsed
+                                       << "s");
+    EXPECT(total == 9 * NUM_KEYS * REPEATS);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace dasi::testing
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -24,6 +24,12 @@ template <> struct default_delete<dasi_key_t> {
     void operator() (const dasi_key_t* k) { CHECK_RETURN(dasi_free_key(k)); }
 
 };
+template <> struct default_delete<dasi_encoder_t> {
+    void operator() (const dasi_encoder_t* e) { CHECK_RETURN(dasi_free_encoder(e)); }
+};
+template <> struct default_delete<dasi_decoder_t> {
+    void operator() (const dasi_decoder_t* d) { CHECK_RETURN(dasi_free_decoder(d)); }
+};
 }
 
 using namespace std::string_literals;
@@ -155,6 +161,67 @@ CASE("Test that clear() works") {
     EXPECT(count == 0);
 }
 
+CASE("Keys can be encoded into a stream") {
+
+    const char* keys[] = {"class=od,stream=oper,param=130", "class=od,stream=oper,param=131",
+                          "class=od,stream=enfo,param=132"};
+
+    dasi_encoder_t* e = nullptr;
+    CHECK_RETURN(dasi_new_encoder(&e));
+    std::unique_ptr<dasi_encoder_t> edeleter(e);
+
+    long singleBytes = 0;
+    for (const char* str : keys) {
+        dasi_key_t* k = nullptr;
+        CHECK_RETURN(dasi_new_key_from_string(&k, str));
+        std::unique_ptr<dasi_key_t> kdeleter(k);
+        CHECK_RETURN(dasi_encoder_add_key(e, k));
+
+        const void* data;
+        long length;
+        CHECK_RETURN(dasi_key_encode(k, &data, &length));
+        singleBytes += length;
+    }
+
+    const void* data = nullptr;
+    long length = 0;
+    CHECK_RETURN(dasi_encoder_buffer(e, &data, &length));
+    EXPECT(length > 0);
+
+    // The keywords are only written once
+    EXPECT(length < singleBytes);
+
+    dasi_decoder_t* d = nullptr;
+    CHECK_RETURN(dasi_new_decoder(&d, data, length));
+    std::unique_ptr<dasi_decoder_t> ddeleter(d);
+
+    // The decoder has its own copy of the stream
+    CHECK_RETURN(dasi_encoder_clear(e));
+
+    dasi_bool_t done = true;
+    for (const char* str : keys) {
+        CHECK_RETURN(dasi_decoder_done(d, &done));
+        EXPECT(!done);
+
+        dasi_key_t* expected = nullptr;
+        CHECK_RETURN(dasi_new_key_from_string(&expected, str));
+        std::unique_ptr<dasi_key_t> xdeleter(expected);
+
+        dasi_key_t* k = nullptr;
+        CHECK_RETURN(dasi_decoder_next_key(d, &k));
+        std::unique_ptr<dasi_key_t> kdeleter(k);
+
+        int cmp = 1;
+        CHECK_RETURN(dasi_key_compare(k, expected, &cmp));
+        EXPECT(cmp == 0);
+    }
+    CHECK_RETURN(dasi_decoder_done(d, &done));
+    EXPECT(done);
+
+    dasi_key_t* k = nullptr;
+    EXPECT(dasi_decoder_next_key(d, &k) == DASI_ERROR_USER);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 int main(int argc, char** argv) {
@@ -19,6 +19,8 @@
 #include <tuple>
 #include <memory>
 #include <cstring>
+#include <ctime>
+#include <string>
 
 #define CHECK_RETURN(x) EXPECT((x) == DASI_SUCCESS);
 
@@ -38,6 +40,9 @@ template <> struct default_delete<dasi_list_t> {
 template <> struct default_delete<dasi_retrieve_t> {
     void operator() (const dasi_retrieve_t* r) { CHECK_RETURN(dasi_free_retrieve(r)); }
 };
+template <> struct default_delete<dasi_list_options_t> {
+    void operator() (const dasi_list_options_t* o) { CHECK_RETURN(dasi_free_list_options(o)); }
+};
 }
 
 
@@ -183,6 +188,42 @@ CASE("simple archive") {
         constexpr const char test_data[] = "TESTING SIMPLE ARCHIVE";
         CHECK_RETURN(dasi_archive(dasi, key, test_data, sizeof(test_data) - 1));
     }
+
+    SECTION("streaming archive") {
+
+        dasi_key_t* key;
+        CHECK_RETURN(dasi_new_key_from_string(&key, "key1=value1,key2=123,key3=value1,key1a=value1,key2a=value1,"
+                                                    "key3a=321,key1b=value1,key2b=value1,key3b=stream"));
+        EXPECT(key);
+        std::unique_ptr<dasi_key_t> kdeleter(key);
+
+        // A tiny length hint, such that the staging memory has to grow
+        dasi_archive_stream_t* stream;
+        CHECK_RETURN(dasi_archive_stream_open(dasi, key, 4, &stream));
+        EXPECT(stream);
+
+        for (const char* chunk : {"TESTING ", "STREAMING ", "ARCHIVE"}) {
+            CHECK_RETURN(dasi_archive_stream_write(stream, chunk, ::strlen(chunk)));
+        }
+        CHECK_RETURN(dasi_archive_stream_commit(stream));
+        CHECK_RETURN(dasi_free_archive_stream(stream));
+        CHECK_RETURN(dasi_flush(dasi));
+
+        dasi_query_t* query;
+        CHECK_RETURN(dasi_new_query_from_string(&query, "key1=value1,key2=123,key3=value1,key1a=value1,key2a=value1,"
+                                                        "key3a=321,key1b=value1,key2b=value1,key3b=stream"));
+        std::unique_ptr<dasi_query_t> qdeleter(query);
+
+        dasi_retrieve_t* ret;
+        CHECK_RETURN(dasi_retrieve(dasi, query, &ret));
+        std::unique_ptr<dasi_retrieve_t> rdeleter(ret);
+
+        char buffer[64];
+        long length = sizeof(buffer);
+        CHECK_RETURN(dasi_retrieve_read(ret, buffer, &length));
+        EXPECT(length == 25);
+        EXPECT(::memcmp(buffer, "TESTING STREAMING ARCHIVE", 25) == 0);
+    }
 }
 
 
@@ -258,6 +299,106 @@ CASE("Accessing data that has been archived") {
         checker.check(dasi, query);
     }
 
+    SECTION("We can count and list only the keys") {
+
+        dasi_query_t* query;
+        CHECK_RETURN(dasi_new_query_from_string(&query, "key1=value1,key2=123,key3=value1"));
+        std::unique_ptr<dasi_query_t> qdeleter(query);
+
+        dasi_list_options_t* options;
+        CHECK_RETURN(dasi_new_list_options(&options));
+        CHECK_RETURN(dasi_list_options_set_fields(options, DASI_LIST_KEYS));
+
+        dasi_list_t* list;
+        CHECK_RETURN(dasi_list_with_options(dasi, query, options, &list));
+        CHECK_RETURN(dasi_free_list_options(options));
+        std::unique_ptr<dasi_list_t> ldeleter(list);
+
+        long count;
+        CHECK_RETURN(dasi_list_count(list, &count));
+        EXPECT(count == 3);
+
+        long found = 0;
+        while (dasi_list_next(list) == DASI_SUCCESS) {
+            dasi_key_t* key;
+            dasi_time_t timestamp;
+            const char* uri;
+            long offset;
+            CHECK_RETURN(dasi_list_attrs(list, &key, &timestamp, &uri, &offset, nullptr));
+            std::unique_ptr<dasi_key_t> kdeleter(key);
+            EXPECT(timestamp == 0);
+            EXPECT(::strlen(uri) == 0);
+            EXPECT(offset == 0);
+            ++found;
+        }
+        EXPECT(found == count);
+    }
+
+    SECTION("We can list only the data archived since a time") {
+
+        dasi_query_t* query;
+        CHECK_RETURN(dasi_new_query_from_string(&query, "key1=value1,key2=123,key3=value1"));
+        std::unique_ptr<dasi_query_t> qdeleter(query);
+
+        dasi_list_options_t* options;
+        CHECK_RETURN(dasi_new_list_options(&options));
+        std::unique_ptr<dasi_list_options_t> odeleter(options);
+
+        for (dasi_time_t since : {dasi_time_t(0), dasi_time_t(::time(nullptr) + 3600)}) {
+            CHECK_RETURN(dasi_list_options_set_since(options, since));
+
+            dasi_list_t* list;
+            CHECK_RETURN(dasi_list_with_options(dasi, query, options, &list));
+            std::unique_ptr<dasi_list_t> ldeleter(list);
+
+            long count;
+            CHECK_RETURN(dasi_list_count(list, &count));
+            EXPECT(count == (since == 0 ? 3 : 0));
+
+            long found = 0;
+            while (dasi_list_next(list) == DASI_SUCCESS) { ++found; }
+            EXPECT(found == count);
+        }
+    }
+
+    SECTION("We can list the data in pages") {
+
+        dasi_query_t* query;
+        CHECK_RETURN(dasi_new_query_from_string(&query, "key1=value1,key2=123,key3=value1"));
+        std::unique_ptr<dasi_query_t> qdeleter(query);
+
+        dasi_list_options_t* options;
+        CHECK_RETURN(dasi_new_list_options(&options));
+        std::unique_ptr<dasi_list_options_t> odeleter(options);
+        CHECK_RETURN(dasi_list_options_set_limit(options, 2));
+        EXPECT(dasi_list_options_set_limit(options, -1) == DASI_ERROR_USER);
+
+        std::string cursor;
+        long found = 0;
+        long pages = 0;
+        do {
+            CHECK_RETURN(dasi_list_options_set_cursor(options, cursor.c_str()));
+
+            dasi_list_t* list;
+            CHECK_RETURN(dasi_list_with_options(dasi, query, options, &list));
+            std::unique_ptr<dasi_list_t> ldeleter(list);
+
+            long count;
+            CHECK_RETURN(dasi_list_count(list, &count));
+            EXPECT(count == 3);
+
+            while (dasi_list_next(list) == DASI_SUCCESS) { ++found; }
+
+            const char* next;
+            CHECK_RETURN(dasi_list_cursor(list, &next));
+            cursor = next;
+            ++pages;
+        } while (!cursor.empty());
+
+        EXPECT(found == 3);
+        EXPECT(pages == 2);
+    }
+
     SECTION("We can list a subset of the data") {
 
         dasi_query_t* query;